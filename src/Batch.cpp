@@ -0,0 +1,185 @@
+/*
+ * Batch.cpp
+ *
+ *  Created on: Mar 17, 2014
+ *  Author: stefan
+ *
+ * Batch mode: solve many instances in one process with a pool of worker threads.
+ * Every worker loads and solves one instance at a time with a sequential engine,
+ * and writes one tab separated result record per instance to stdout.
+ */
+
+#include "Parallel.hpp"
+#include "RMC.hpp"
+
+#include <gecode/search.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+
+#include <glob.h>
+
+struct BatchResult {
+  std::string status;
+  int cost;
+  double time;
+  unsigned long int nodes;
+  unsigned long int fails;
+
+  BatchResult() : status("unknown"), cost(-1), time(0), nodes(0), fails(0) {}
+};
+
+class BatchRunner {
+public:
+  BatchRunner(const RMCOptions &opt, const std::vector<std::string> &files)
+  : _opt(opt), _files(files), _next(0)
+  {}
+
+  void run(unsigned int workers);
+
+private:
+  void work();
+
+  void solve(const std::string &file, BatchResult &result);
+
+  const RMCOptions &_opt;
+  const std::vector<std::string> &_files;
+
+  // index of the next instance to solve, protected by _mutex
+  size_t _next;
+
+  // protects _next and the output
+  std::mutex _mutex;
+};
+
+void BatchRunner::run(unsigned int workers)
+{
+  std::cout << "instance\tstatus\tcost\ttime_ms\tnodes\tfails" << std::endl;
+
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < workers; i++) {
+    threads.push_back(std::thread(&BatchRunner::work, this));
+  }
+  for (unsigned int i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+}
+
+void BatchRunner::work()
+{
+  while (true) {
+    size_t idx;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_next >= _files.size()) return;
+      idx = _next++;
+    }
+
+    BatchResult result;
+    solve(_files[idx], result);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::cout << _files[idx] << "\t" << result.status << "\t" << result.cost << "\t"
+              << result.time << "\t" << result.nodes << "\t" << result.fails << std::endl;
+  }
+}
+
+void BatchRunner::solve(const std::string &file, BatchResult &result)
+{
+  Support::Timer timer;
+  timer.start();
+
+  RMCInput input;
+  if (!input.loadProblem(file.c_str())) {
+    result.status = "error";
+    result.time = timer.stop();
+    return;
+  }
+
+  for (int i = 0; i < input.getNumOrders(); i++) {
+    if (input.getMinDeliveries(i) == -1) {
+      result.status = "infeasible";
+      result.time = timer.stop();
+      return;
+    }
+  }
+
+  RMCOptions opt(_opt.name(), input);
+  opt.copySettings(_opt);
+  if (_opt.heuristic() != HEURISTIC_NONE && input.getHeuristicCost() >= 0) {
+    opt.setCostBound(input.getHeuristicCost());
+  }
+
+  RMCScript *root = RMCScript::create(opt);
+
+  Search::Options so;
+  // Instances are already solved in parallel
+  so.threads = 1;
+  Search::TimeStop *stop = _opt.time() > 0 ? new Search::TimeStop(_opt.time()) : NULL;
+  so.stop = stop;
+
+  Search::Statistics stat;
+  bool stopped;
+  RMCScript *best = searchBest(root, opt, so, stat, stopped);
+
+  if (best) {
+    result.status = stopped ? "feasible" : "optimal";
+    result.cost = best->cost().val();
+  } else {
+    result.status = stopped ? "timeout" : "infeasible";
+  }
+  result.nodes = stat.node;
+  result.fails = stat.fail;
+  result.time = timer.stop();
+
+  delete best;
+  delete stop;
+}
+
+/// Expand a glob pattern, or read a list of files from @listfile
+static void getInstances(const char *pattern, std::vector<std::string> &files)
+{
+  if (pattern[0] == '@') {
+    std::ifstream list(pattern + 1);
+    std::string line;
+    while (std::getline(list, line)) {
+      if (!line.empty()) files.push_back(line);
+    }
+    return;
+  }
+
+  glob_t g;
+  if (glob(pattern, 0, NULL, &g) == 0) {
+    for (size_t i = 0; i < g.gl_pathc; i++) {
+      files.push_back(g.gl_pathv[i]);
+    }
+  }
+  globfree(&g);
+}
+
+int runBatch(const RMCOptions &opt)
+{
+  std::vector<std::string> files;
+  getInstances(opt.batch(), files);
+
+  if (files.empty()) {
+    std::cerr << "error: no instances found for " << opt.batch() << "\n";
+    return 1;
+  }
+
+  unsigned int workers = opt.workers();
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers = std::min<unsigned int>(workers, files.size());
+
+  BatchRunner runner(opt, files);
+  runner.run(workers);
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * CompiledInput.cpp
+ *
+ *  Created on: Mar 14, 2014
+ *  Author: stefan
+ *
+ * Compiled instance files: a verbatim, host-endian copy of the instance arena of an RMCInput
+ * (see InstanceLayout.hpp) that is memory mapped and used in place, without parsing XML.
+ * The checksum in the header covers everything after the header.
+ */
+
+#include "Problem.hpp"
+#include "InstanceLayout.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/// FNV-1a over the payload
+static uint32_t checksum(const char *data, uint64_t size) {
+  uint32_t hash = 2166136261u;
+  for (uint64_t i = 0; i < size; i++) {
+    hash ^= (unsigned char) data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+bool RMCInput::isCompiled(const char* filename)
+{
+  FILE *f = fopen(filename, "rb");
+  if (!f) return false;
+
+  char magic[8];
+  bool compiled = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+                  memcmp(magic, INSTANCE_MAGIC, sizeof(magic)) == 0;
+  fclose(f);
+  return compiled;
+}
+
+bool RMCInput::saveCompiled(const char* filename) const
+{
+  if (_numVehicles == 0) {
+    std::cerr << "error: no vehicles available, nothing to compile\n";
+    return false;
+  }
+
+  InstanceHeader header = *(const InstanceHeader*) _arena;
+  uint64_t start = alignArena(sizeof(InstanceHeader));
+  header.checksum = checksum(_arena + start, _arenaSize - start);
+
+  FILE *f = fopen(filename, "wb");
+  if (!f) {
+    std::cerr << "error: could not write compiled instance " << filename << "\n";
+    return false;
+  }
+  bool ok = fwrite(&header, 1, sizeof(header), f) == sizeof(header) &&
+            fwrite(_arena + sizeof(header), 1, _arenaSize - sizeof(header), f) == _arenaSize - sizeof(header);
+  ok = (fclose(f) == 0) && ok;
+  if (!ok) {
+    std::cerr << "error: could not write compiled instance " << filename << "\n";
+  }
+  return ok;
+}
+
+bool RMCInput::loadCompiled(const char* filename)
+{
+  int fd = open(filename, O_RDONLY);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(InstanceHeader)) {
+    printf("error: could not read compiled instance %s\n", filename);
+    if (fd != -1) close(fd);
+    return false;
+  }
+  void *mapping = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    printf("error: could not map compiled instance %s\n", filename);
+    return false;
+  }
+
+  const char *base = (const char*) mapping;
+  const InstanceHeader &header = *(const InstanceHeader*) base;
+  uint64_t start = alignArena(sizeof(InstanceHeader));
+
+  bool valid = header.version == INSTANCE_VERSION && header.arenaSize == (uint64_t) st.st_size &&
+               header.checksum == checksum(base + start, header.arenaSize - start);
+  for (int i = 0; valid && i < IC_NUM_COLUMNS; i++) {
+    valid = header.offset[i] % ARENA_ALIGNMENT == 0 && header.offset[i] + header.size[i] <= header.arenaSize;
+  }
+  if (!valid) {
+    printf("error: compiled instance %s is corrupt or of an unsupported version, recompile it\n", filename);
+    munmap(mapping, st.st_size);
+    return false;
+  }
+
+  // the mapping becomes the arena, all columns point directly into it
+  releaseArena();
+  attachArena((char*) mapping, st.st_size, true);
+
+  return true;
+}
@@ -0,0 +1,147 @@
+/*
+ * CostBound.cpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#include "CostBound.hpp"
+
+#include <algorithm>
+
+/// Apply a modification event, fail the propagator or note the change
+#define BOUND_MODIFY(me) do {                  \
+    ModEvent me_ = (me);                       \
+    GECODE_ME_CHECK(me_);                      \
+    changed = changed || me_modified(me_);     \
+  } while (0)
+
+class CostLowerBound : public Propagator {
+protected:
+  Int::IntView _cost;
+  ViewArray<Int::IntView> _terms;
+  ViewArray<Int::IntView> _travel;
+  ViewArray<Int::IntView> _deliveries;
+
+  SharedArray<int> _weights;
+  SharedArray<int> _minTravel;
+  int _travelWeight;
+
+  CostLowerBound(Space &home, bool share, CostLowerBound &p)
+  : Propagator(home, share, p), _travelWeight(p._travelWeight)
+  {
+    _cost.update(home, share, p._cost);
+    _terms.update(home, share, p._terms);
+    _travel.update(home, share, p._travel);
+    _deliveries.update(home, share, p._deliveries);
+    _weights.update(home, share, p._weights);
+    _minTravel.update(home, share, p._minTravel);
+  }
+
+public:
+  CostLowerBound(Home home, Int::IntView cost, ViewArray<Int::IntView> &terms, ViewArray<Int::IntView> &travel,
+                 ViewArray<Int::IntView> &deliveries, const SharedArray<int> &weights,
+                 const SharedArray<int> &minTravel, int travelWeight)
+  : Propagator(home), _cost(cost), _terms(terms), _travel(travel), _deliveries(deliveries),
+    _weights(weights), _minTravel(minTravel), _travelWeight(travelWeight)
+  {
+    _cost.subscribe(home, *this, Int::PC_INT_BND);
+    _terms.subscribe(home, *this, Int::PC_INT_BND);
+    _travel.subscribe(home, *this, Int::PC_INT_BND);
+    _deliveries.subscribe(home, *this, Int::PC_INT_BND);
+  }
+
+  static ExecStatus post(Home home, Int::IntView cost, ViewArray<Int::IntView> &terms,
+                         ViewArray<Int::IntView> &travel, ViewArray<Int::IntView> &deliveries,
+                         const SharedArray<int> &weights, const SharedArray<int> &minTravel, int travelWeight)
+  {
+    (void) new (home) CostLowerBound(home, cost, terms, travel, deliveries, weights, minTravel, travelWeight);
+    return ES_OK;
+  }
+
+  virtual Actor* copy(Space &home, bool share)
+  {
+    return new (home) CostLowerBound(home, share, *this);
+  }
+
+  virtual PropCost cost(const Space&, const ModEventDelta&) const
+  {
+    return PropCost::linear(PropCost::LO, _terms.size() + _travel.size() + _deliveries.size());
+  }
+
+  virtual size_t dispose(Space &home)
+  {
+    _cost.cancel(home, *this, Int::PC_INT_BND);
+    _terms.cancel(home, *this, Int::PC_INT_BND);
+    _travel.cancel(home, *this, Int::PC_INT_BND);
+    _deliveries.cancel(home, *this, Int::PC_INT_BND);
+    _weights.~SharedArray<int>();
+    _minTravel.~SharedArray<int>();
+    (void) Propagator::dispose(home);
+    return sizeof(*this);
+  }
+
+  virtual ExecStatus propagate(Space &home, const ModEventDelta&)
+  {
+    bool changed;
+    do {
+      changed = false;
+
+      long long bound = 0;
+      for (int j = 0; j < _terms.size(); j++) {
+        bound += (long long) _weights[j] * _terms[j].min();
+      }
+
+      // Every delivery travels at least the shortest trip to the yard of its order
+      long long slotTravel = 0;
+      for (int d = 0; d < _travel.size(); d++) {
+        slotTravel += _travel[d].min();
+      }
+      long long orderTravel = 0;
+      for (int i = 0; i < _deliveries.size(); i++) {
+        orderTravel += (long long) _deliveries[i].min() * _minTravel[i];
+      }
+      long long travel = std::max(slotTravel, orderTravel);
+      bound += _travelWeight * travel;
+
+      BOUND_MODIFY(_cost.gq(home, bound));
+
+      // Nothing may exceed its minimum by more than the slack of the cost
+      long long slack = _cost.max() - bound;
+      for (int j = 0; j < _terms.size(); j++) {
+        if (_weights[j] <= 0) continue;
+        BOUND_MODIFY(_terms[j].lq(home, _terms[j].min() + slack / _weights[j]));
+      }
+      if (_travelWeight > 0) {
+        long long room = slack / _travelWeight;
+        for (int d = 0; d < _travel.size(); d++) {
+          BOUND_MODIFY(_travel[d].lq(home, _travel[d].min() + travel - slotTravel + room));
+        }
+        for (int i = 0; i < _deliveries.size(); i++) {
+          if (_minTravel[i] <= 0) continue;
+          BOUND_MODIFY(_deliveries[i].lq(home, _deliveries[i].min() + (travel - orderTravel + room) / _minTravel[i]));
+        }
+      }
+    } while (changed);
+
+    if (_cost.assigned() && _terms.assigned() && _travel.assigned() && _deliveries.assigned()) {
+      return home.ES_SUBSUMED(*this);
+    }
+    return ES_FIX;
+  }
+};
+
+void costLowerBound(Home home, IntVar cost, const IntVarArgs &terms, const IntArgs &weights,
+                    const IntVarArgs &travel, const IntVarArgs &deliveries, const IntArgs &minTravel,
+                    int travelWeight)
+{
+  if (home.failed()) return;
+
+  Int::IntView c(cost);
+  ViewArray<Int::IntView> t(home, terms);
+  ViewArray<Int::IntView> tr(home, travel);
+  ViewArray<Int::IntView> d(home, deliveries);
+
+  GECODE_ES_FAIL(CostLowerBound::post(home, c, t, tr, d, SharedArray<int>(weights), SharedArray<int>(minTravel),
+                                      travelWeight));
+}
@@ -0,0 +1,28 @@
+/*
+ * CostBound.hpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#ifndef COSTBOUND_HPP_
+#define COSTBOUND_HPP_
+
+#include <gecode/int.hh>
+
+using namespace Gecode;
+
+/**
+ * Lower bound of the weighted cost:
+ *
+ *   cost >= sum weights[j] * terms[j] + travelWeight * max(sum travel[d], sum deliveries[i] * minTravel[i])
+ *
+ * travel holds the trip to the yard of every delivery slot, deliveries the number of deliveries
+ * per order, each of which travels at least minTravel of its order. What is left of cost.max()
+ * after the bound limits all terms, trips and deliveries in return.
+ */
+void costLowerBound(Home home, IntVar cost, const IntVarArgs &terms, const IntArgs &weights,
+                    const IntVarArgs &travel, const IntVarArgs &deliveries, const IntArgs &minTravel,
+                    int travelWeight);
+
+#endif
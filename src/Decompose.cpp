@@ -0,0 +1,325 @@
+/*
+ * Decompose.cpp
+ *
+ *  Created on: Mar 20, 2014
+ *  Author: stefan
+ *
+ * Decomposition of an instance into components that do not share vehicles and never load at
+ * the same time. Every component is extracted as its own RMCInput and solved by a worker
+ * thread with a sequential engine, the schedules are merged afterwards.
+ */
+
+#include "Decompose.hpp"
+#include "Parallel.hpp"
+#include "RMC.hpp"
+
+#include <gecode/search.hh>
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+static int findRoot(std::vector<int> &parent, int i)
+{
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+static void join(std::vector<int> &parent, int a, int b)
+{
+  parent[findRoot(parent, a)] = findRoot(parent, b);
+}
+
+/// Sort orders by the start of their loading window
+struct WindowStartLess {
+  const std::vector<int> &start;
+
+  WindowStartLess(const std::vector<int> &s) : start(s) {}
+
+  bool operator()(int a, int b) const {
+    return start[a] < start[b] || (start[a] == start[b] && a < b);
+  }
+};
+
+void findComponents(const RMCInput &input, std::vector<Component> &components)
+{
+  int numO = input.getNumOrders();
+  int numV = input.getNumVehicles();
+
+  components.clear();
+
+  std::vector<int> parent(numO);
+  for (int i = 0; i < numO; i++) {
+    parent[i] = i;
+  }
+
+  // orders that can be served by the same vehicle
+  std::vector<int> firstOrder(numV, -1);
+  for (int v = 0; v < numV; v++) {
+    for (int o = 0; o < numO; o++) {
+      if (!input.canServe(v, o)) continue;
+
+      if (firstOrder[v] == -1) {
+        firstOrder[v] = o;
+      } else {
+        join(parent, firstOrder[v], o);
+      }
+    }
+  }
+
+  // orders that may be loaded at the same time at some station, or unloaded at the same time
+  // at their yard. Unloading starts between the order start and its deadline. Loading is assumed
+  // to start at most TimeMax before unloading; the models allow earlier loading at the cost of
+  // waste, so solveComponents checks the merged schedule.
+  int maxLoadTime = 0;
+  for (int s = 0; s < input.getNumStations(); s++) {
+    maxLoadTime = std::max(maxLoadTime, input.getStationLoadTimes()[s]);
+  }
+
+  std::vector<int> windowStart(numO);
+  std::vector<int> windowEnd(numO);
+  std::vector<int> orders(numO);
+  for (int o = 0; o < numO; o++) {
+    int maxUnloadTime = 0;
+    for (int v = 0; v < numV; v++) {
+      if (!input.canServe(v, o)) continue;
+      maxUnloadTime = std::max(maxUnloadTime, input.getUnloadingTime(o, v));
+    }
+
+    windowStart[o] = input.getOrderStartTimes()[o] - input.getTimeMax();
+    windowEnd[o] = input.getOrderDeadlines()[o] + std::max(maxLoadTime, maxUnloadTime);
+    orders[o] = o;
+  }
+  std::sort(orders.begin(), orders.end(), WindowStartLess(windowStart));
+
+  // overlapping windows form contiguous runs in start order
+  int end = INT_MIN;
+  for (int i = 0; i < numO; i++) {
+    int o = orders[i];
+    if (i > 0 && windowStart[o] < end) {
+      join(parent, orders[i-1], o);
+    }
+    end = std::max(end, windowEnd[o]);
+  }
+
+  std::vector<int> componentOf(numO, -1);
+  for (int o = 0; o < numO; o++) {
+    int root = findRoot(parent, o);
+    if (componentOf[root] == -1) {
+      componentOf[root] = components.size();
+      components.push_back(Component());
+    }
+    components[componentOf[root]].orders.push_back(o);
+  }
+  for (int v = 0; v < numV; v++) {
+    if (firstOrder[v] == -1) continue;
+    components[componentOf[findRoot(parent, firstOrder[v])]].vehicles.push_back(v);
+  }
+}
+
+/// Start and end of a loading or unloading, per station or yard
+typedef std::vector< std::vector< std::pair<int,int> > > Occupation;
+
+/// True if no two intervals of the same station or yard overlap
+static bool disjoint(Occupation &occupation)
+{
+  for (size_t r = 0; r < occupation.size(); r++) {
+    std::sort(occupation[r].begin(), occupation[r].end());
+    for (size_t i = 1; i < occupation[r].size(); i++) {
+      if (occupation[r][i].first < occupation[r][i-1].second) return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * True if the merged schedule loads at most one vehicle per station and unloads at most one per
+ * yard at a time. The windows of findComponents assume that loading starts at most TimeMax before
+ * unloading, which the models do not enforce, so components may still meet at a station.
+ */
+static bool isDisjoint(const RMCInput &input, const Schedule &schedule)
+{
+  Occupation stations(input.getNumStations());
+  Occupation yards(input.getNumYards());
+
+  const std::vector<ScheduledDelivery> &deliveries = schedule.getDeliveries();
+  for (size_t i = 0; i < deliveries.size(); i++) {
+    const ScheduledDelivery &d = deliveries[i];
+    int load = input.getStationLoadTimes()[d.station];
+    int unload = input.getUnloadingTime(d.order, d.vehicle);
+
+    stations[d.station].push_back(std::make_pair(d.tLoad, d.tLoad + load));
+    yards[input.getOrderYards()[d.order]].push_back(std::make_pair(d.tUnload, d.tUnload + unload));
+  }
+
+  return disjoint(stations) && disjoint(yards);
+}
+
+struct ComponentResult {
+  // schedule using the indices of the whole instance
+  Schedule schedule;
+  bool solved;
+  bool optimal;
+
+  ComponentResult() : solved(false), optimal(false) {}
+};
+
+class ComponentSolver {
+public:
+  ComponentSolver(const RMCOptions &opt, const std::vector<Component> &components,
+                  std::vector<ComponentResult> &results)
+  : _opt(opt), _components(components), _results(results), _next(0)
+  {}
+
+  void run(unsigned int workers);
+
+private:
+  void work();
+
+  void solve(const Component &component, ComponentResult &result);
+
+  const RMCOptions &_opt;
+  const std::vector<Component> &_components;
+  std::vector<ComponentResult> &_results;
+
+  // index of the next component to solve, protected by _mutex
+  size_t _next;
+
+  std::mutex _mutex;
+};
+
+void ComponentSolver::run(unsigned int workers)
+{
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < workers; i++) {
+    threads.push_back(std::thread(&ComponentSolver::work, this));
+  }
+  for (unsigned int i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+}
+
+void ComponentSolver::work()
+{
+  while (true) {
+    size_t idx;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_next >= _components.size()) return;
+      idx = _next++;
+    }
+
+    solve(_components[idx], _results[idx]);
+  }
+}
+
+void ComponentSolver::solve(const Component &component, ComponentResult &result)
+{
+  RMCInput input;
+  if (!input.loadSubProblem(_opt.getInput(), component.orders, component.vehicles)) {
+    return;
+  }
+
+  RMCOptions opt(_opt.name(), input);
+  opt.copySettings(_opt);
+  if (_opt.heuristic() != HEURISTIC_NONE && input.getHeuristicCost() >= 0) {
+    opt.setCostBound(input.getHeuristicCost());
+  }
+
+  RMCScript *root = RMCScript::create(opt);
+
+  Search::Options so;
+  // Components are already solved in parallel
+  so.threads = 1;
+  Search::TimeStop *stop = _opt.time() > 0 ? new Search::TimeStop(_opt.time()) : NULL;
+  so.stop = stop;
+
+  Search::Statistics stat;
+  bool stopped;
+  RMCScript *best = searchBest(root, opt, so, stat, stopped);
+
+  if (best) {
+    Schedule schedule;
+    best->getSchedule(schedule);
+
+    // map back to the orders and vehicles of the whole instance, stations are the same
+    const std::vector<ScheduledDelivery> &deliveries = schedule.getDeliveries();
+    for (size_t i = 0; i < deliveries.size(); i++) {
+      const ScheduledDelivery &d = deliveries[i];
+      result.schedule.addDelivery(component.vehicles[d.vehicle], component.orders[d.order], d.station,
+                                  d.tLoad, d.tUnload);
+    }
+    result.schedule.setCost(schedule.getCost());
+    result.solved = true;
+    result.optimal = !stopped;
+  }
+
+  delete best;
+  delete stop;
+}
+
+bool solveComponents(const RMCOptions &opt, const std::vector<Component> &components)
+{
+  const RMCInput &input = opt.getInput();
+
+  unsigned int workers = opt.workers();
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers = std::min<unsigned int>(workers, components.size());
+
+  std::vector<ComponentResult> results(components.size());
+  ComponentSolver solver(opt, components, results);
+  solver.run(workers);
+
+  Schedule schedule;
+  int cost = 0;
+  bool optimal = true;
+
+  for (size_t i = 0; i < components.size(); i++) {
+    const ComponentResult &result = results[i];
+
+    std::cout << "Component " << i << ": " << components[i].orders.size() << " orders, "
+              << components[i].vehicles.size() << " vehicles, ";
+    if (!result.solved) {
+      std::cout << "no solution" << std::endl;
+      return false;
+    }
+    std::cout << "cost " << result.schedule.getCost() << (result.optimal ? " (optimal)" : "") << std::endl;
+
+    const std::vector<ScheduledDelivery> &deliveries = result.schedule.getDeliveries();
+    for (size_t j = 0; j < deliveries.size(); j++) {
+      const ScheduledDelivery &d = deliveries[j];
+      schedule.addDelivery(d.vehicle, d.order, d.station, d.tLoad, d.tUnload);
+    }
+    cost += result.schedule.getCost();
+    optimal = optimal && result.optimal;
+  }
+
+  // Components share no vehicles, so they can only meet at a station or yard
+  if (!isDisjoint(input, schedule)) {
+    std::cout << "Components load or unload at the same time at a station or yard" << std::endl;
+    return false;
+  }
+
+  // Components share no vehicles and never load at the same time, so the costs add up
+  schedule.setCost(schedule.computeCost(input));
+  if (schedule.getCost() != cost) {
+    std::cout << "Merged schedule has cost " << schedule.getCost() << " instead of " << cost << std::endl;
+    return false;
+  }
+
+  std::cout << std::endl;
+  schedule.print(std::cout, input);
+  if (opt.solutionFile()) {
+    schedule.write(opt.solutionFile(), input);
+  }
+  std::cout << std::endl << "Cost: " << cost << (optimal ? " (optimal)" : "") << std::endl;
+
+  return true;
+}
@@ -0,0 +1,36 @@
+/*
+ * Decompose.hpp
+ *
+ *  Created on: Mar 20, 2014
+ *  Author: stefan
+ */
+
+#ifndef DECOMPOSE_HPP_
+#define DECOMPOSE_HPP_
+
+#include "Problem.hpp"
+
+#include <vector>
+
+class RMCOptions;
+
+/// Orders and vehicles of an independent part of an instance
+struct Component {
+  std::vector<int> orders;
+  std::vector<int> vehicles;
+};
+
+/**
+ * Split an instance into components that can be solved independently: orders are in the same
+ * component if a vehicle can serve both, or if their deliveries may be loaded or unloaded at
+ * overlapping times (between start - TimeMax and deadline). Vehicles that can not serve any order
+ * are dropped.
+ */
+void findComponents(const RMCInput &input, std::vector<Component> &components);
+
+/// Solve all components concurrently with opt.time() as time budget per component, print the
+/// merged schedule. Returns false if some component could not be solved, or if the schedules of
+/// two components use a station or yard at the same time.
+bool solveComponents(const RMCOptions &opt, const std::vector<Component> &components);
+
+#endif
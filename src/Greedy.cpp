@@ -0,0 +1,191 @@
+/*
+ * Greedy.cpp
+ *
+ *  Created on: Mar 19, 2014
+ *  Author: stefan
+ */
+
+#include "Greedy.hpp"
+
+#include <algorithm>
+
+/// Sort orders by start time
+struct OrderStartLess {
+  const RMCInput &input;
+
+  OrderStartLess(const RMCInput &in) : input(in) {}
+
+  bool operator()(int a, int b) const {
+    int sa = input.getOrderStartTimes()[a];
+    int sb = input.getOrderStartTimes()[b];
+    return sa < sb || (sa == sb && a < b);
+  }
+};
+
+ListScheduler::ListScheduler(const RMCInput &input)
+: _input(input), _makespan(0)
+{}
+
+void ListScheduler::reset()
+{
+  _vehicleDeliveries.assign(_input.getNumVehicles(), 0);
+  _vehicleLastOrder.assign(_input.getNumVehicles(), -1);
+  _vehicleFree.assign(_input.getNumVehicles(), 0);
+  _stationLoads.assign(_input.getNumStations(), std::vector<int>());
+  _yardUnloads.assign(_input.getNumYards(), std::vector< std::pair<int,int> >());
+  _makespan = 0;
+}
+
+int ListScheduler::getStationFree(int s, int t) const
+{
+  int load = _input.getStationLoadTimes()[s];
+  const std::vector<int> &loads = _stationLoads[s];
+
+  for (size_t i = 0; i < loads.size(); i++) {
+    if (loads[i] >= t + load) break;
+    if (loads[i] + load > t) {
+      t = loads[i] + load;
+    }
+  }
+  return t;
+}
+
+int ListScheduler::getYardFree(int y, int t, int duration) const
+{
+  // unloadings at a yard do not overlap, so they are sorted by end as well
+  const std::vector< std::pair<int,int> > &unloads = _yardUnloads[y];
+
+  for (size_t i = 0; i < unloads.size(); i++) {
+    if (unloads[i].first >= t + duration) break;
+    if (unloads[i].second > t) {
+      t = unloads[i].second;
+    }
+  }
+  return t;
+}
+
+bool ListScheduler::run(Schedule &schedule)
+{
+  reset();
+  schedule.clear();
+
+  std::vector<int> orders(_input.getNumOrders());
+  for (size_t i = 0; i < orders.size(); i++) {
+    orders[i] = i;
+  }
+  std::sort(orders.begin(), orders.end(), OrderStartLess(_input));
+
+  for (size_t i = 0; i < orders.size(); i++) {
+    if (!scheduleOrder(orders[i], schedule)) {
+      return false;
+    }
+  }
+
+  schedule.setCost(schedule.computeCost(_input));
+  return true;
+}
+
+bool ListScheduler::scheduleOrder(int o, Schedule &schedule)
+{
+  const Order &order = _input.getOrder(o);
+  int numV = _input.getNumVehicles();
+  int numS = _input.getNumStations();
+  int rate = order.dischargeRate();
+
+  int poured = 0;
+  int deliveries = 0;
+  int lastUnload = -1;
+  int lastDuration = 0;
+
+  while (poured < order.totalVolume()) {
+    int slots = _input.getMaxDeliveries(o) - deliveries;
+    if (slots <= 0 || rate <= 0) {
+      return false;
+    }
+    // every remaining delivery must pour at least this much to finish within the bound
+    int required = std::min(order.totalVolume() - poured, (order.totalVolume() - poured - 1) / slots + 1);
+
+    int bestV = -1, bestS = -1, bestLoad = 0, bestUnload = 0, bestPour = 0;
+
+    for (int v = 0; v < numV; v++) {
+      if (!_input.canServe(v, o)) continue;
+
+      int volume = _input.getOrderVehicleVolumes()[o * numV + v];
+      int duration = _input.getUnloadingTime(o, v);
+
+      // the first delivery of a vehicle is loaded at station 0
+      int firstStation = 0;
+      int lastStation = (_vehicleDeliveries[v] == 0) ? std::min(1, numS) : numS;
+
+      for (int s = firstStation; s < lastStation; s++) {
+        int lead = _input.getStationLoadTimes()[s] + _input.getTravelTimeTo(o, s) + order.dTimeSetup();
+        if (lead >= _input.getTimeMax()) continue;
+
+        int pour = std::min(volume, (_input.getTimeMax() - lead) * rate);
+        if (pour < required) continue;
+
+        int ready;
+        if (_vehicleDeliveries[v] == 0) {
+          ready = _input.getVehicle(v).availableFrom();
+        } else {
+          ready = _vehicleFree[v] + _input.getTravelTimeFrom(_vehicleLastOrder[v], s);
+        }
+
+        // unloading starts after the order start, and after the previous delivery of the order
+        // has been unloaded
+        int target = ready + lead;
+        if (lastUnload < 0) {
+          target = std::max(target, order.timeStart());
+        } else {
+          target = std::max(target, lastUnload + std::max(1, lastDuration));
+        }
+
+        // load as late as possible, so that the concrete is fresh on arrival, and unload
+        // when the yard is free
+        int tLoad, tUnload;
+        while (true) {
+          tLoad = getStationFree(s, target - lead);
+          tUnload = getYardFree(order.yard(), tLoad + lead, duration);
+          if (tUnload == tLoad + lead) break;
+          target = tUnload;
+        }
+
+        if (bestV == -1 || tUnload < bestUnload || (tUnload == bestUnload && pour > bestPour)) {
+          bestV = v;
+          bestS = s;
+          bestLoad = tLoad;
+          bestUnload = tUnload;
+          bestPour = pour;
+        }
+      }
+    }
+
+    if (bestV == -1) {
+      return false;
+    }
+
+    int duration = _input.getUnloadingTime(o, bestV);
+
+    schedule.addDelivery(bestV, o, bestS, bestLoad, bestUnload);
+
+    std::vector<int> &loads = _stationLoads[bestS];
+    loads.insert(std::upper_bound(loads.begin(), loads.end(), bestLoad), bestLoad);
+    
+    std::vector< std::pair<int,int> > &unloads = _yardUnloads[order.yard()];
+    std::pair<int,int> unload(bestUnload, bestUnload + duration);
+    unloads.insert(std::upper_bound(unloads.begin(), unloads.end(), unload), unload);
+
+    _vehicleDeliveries[bestV]++;
+    _vehicleLastOrder[bestV] = o;
+    _vehicleFree[bestV] = bestUnload + duration;
+
+    _makespan = std::max(_makespan, bestUnload);
+
+    poured += bestPour;
+    deliveries++;
+    lastUnload = bestUnload;
+    lastDuration = duration;
+  }
+
+  return true;
+}
@@ -0,0 +1,61 @@
+/*
+ * Greedy.hpp
+ *
+ *  Created on: Mar 19, 2014
+ *  Author: stefan
+ */
+
+#ifndef GREEDY_HPP_
+#define GREEDY_HPP_
+
+#include "Problem.hpp"
+#include "Schedule.hpp"
+
+#include <vector>
+
+/**
+ * List scheduling heuristic. Orders are served by increasing start time, every delivery of
+ * an order goes to the vehicle and station that can start unloading first. Loadings at a
+ * station and unloadings at a construction yard do not overlap.
+ *
+ * The resulting schedule satisfies all constraints of the RMC model, so its cost is an upper
+ * bound on the optimum and its times can be used to bound the scheduling horizon.
+ */
+class ListScheduler {
+public:
+  ListScheduler(const RMCInput &input);
+
+  /// Build a schedule, returns false if some order could not be served completely
+  bool run(Schedule &schedule);
+
+  /// Latest unloading start of the last schedule built
+  int getMakespan() const { return _makespan; }
+
+private:
+  /// Earliest time >= t at which station s is free for loading
+  int getStationFree(int s, int t) const;
+  
+  /// Earliest time >= t at which yard y is free for unloading for the given duration
+  int getYardFree(int y, int t, int duration) const;
+
+  void reset();
+
+  bool scheduleOrder(int order, Schedule &schedule);
+
+  const RMCInput &_input;
+
+  // per vehicle: deliveries so far, order of the last delivery and end of its unloading
+  std::vector<int> _vehicleDeliveries;
+  std::vector<int> _vehicleLastOrder;
+  std::vector<int> _vehicleFree;
+
+  // per station: start times of all loadings, sorted
+  std::vector< std::vector<int> > _stationLoads;
+  
+  // per yard: start and end of all unloadings, sorted
+  std::vector< std::vector< std::pair<int,int> > > _yardUnloads;
+
+  int _makespan;
+};
+
+#endif
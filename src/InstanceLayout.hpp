@@ -0,0 +1,105 @@
+/*
+ * InstanceLayout.hpp
+ *
+ *  Created on: Mar 18, 2014
+ *  Author: stefan
+ *
+ * Memory layout of the instance arena owned by RMCInput. All data of an instance lives
+ * in one block: an InstanceHeader followed by one column per attribute, every column
+ * aligned to ARENA_ALIGNMENT bytes. Names are stored as one offset table per kind plus a
+ * shared character table.
+ *
+ * Compiled instance files are a verbatim copy of the arena, so they can be memory mapped
+ * and used in place.
+ */
+
+#ifndef INSTANCELAYOUT_HPP_
+#define INSTANCELAYOUT_HPP_
+
+#include <stdint.h>
+#include <cstddef>
+
+static const char     INSTANCE_MAGIC[8] = { 'R', 'M', 'C', 'I', 'N', 'S', 'T', '\0' };
+static const uint32_t INSTANCE_VERSION  = 10;
+
+/// Alignment of the arena and of every column, one cache line
+static const size_t   ARENA_ALIGNMENT   = 64;
+
+enum InstanceColumn {
+  // per order
+  IC_ORDER_START_TIMES,
+  IC_ORDER_TOTAL_VOLUMES,
+  IC_ORDER_DISCHARGE_RATES,
+  IC_ORDER_PIPE_LENGTHS,
+  IC_ORDER_SETUP_TIMES,
+  IC_ORDER_PREF_STATIONS,
+  IC_ORDER_MAX_VOLUME,
+  IC_ORDER_YARDS,
+  IC_ORDER_MAX_DELIVERIES,
+  IC_ORDER_MIN_DELIVERIES,
+  // latest start of unloading for any delivery of the order
+  IC_ORDER_DEADLINES,
+  // first delivery slot of every order, numOrders + 1 entries
+  IC_ORDER_DELIVERY_OFFSETS,
+  // per vehicle
+  IC_VEHICLE_PUMP_LENGTHS,
+  IC_VEHICLE_DISCHARGE_RATES,
+  IC_VEHICLE_NORMAL_VOLUMES,
+  IC_VEHICLE_MAX_VOLUMES,
+  IC_VEHICLE_AVAILABLE,
+  IC_VEHICLE_MAX_DELIVERIES,
+  // first vehicle of the equivalence class of every vehicle
+  IC_VEHICLE_CLASSES,
+  // first delivery slot of every vehicle, numVehicles + 1 entries
+  IC_VEHICLE_DELIVERY_OFFSETS,
+  // per station
+  IC_STATION_LOAD_TIMES,
+  // [order, vehicle]
+  IC_ORDER_VEHICLE_VOLUMES,
+  IC_ORDER_VEHICLE_COMPATIBLE,
+  // [yard, station]
+  IC_TRAVEL_TO,
+  IC_TRAVEL_FROM,
+  // name offsets, numX + 1 entries each
+  IC_ORDER_NAMES,
+  IC_VEHICLE_NAMES,
+  IC_STATION_NAMES,
+  IC_YARD_NAMES,
+  // characters of all names, size in bytes
+  IC_NAME_CHARS,
+  IC_NUM_COLUMNS
+};
+
+struct InstanceHeader {
+  char     magic[8];
+  uint32_t version;
+  /// FNV-1a over everything after the header, only set in compiled files
+  uint32_t checksum;
+
+  int32_t  numOrders;
+  int32_t  numVehicles;
+  int32_t  numStations;
+  int32_t  numYards;
+  // sum of the delivery bounds of all orders
+  int32_t  maxDeliveries;
+  int32_t  maxTimeStamp;
+  int32_t  additiveTimeStamp;
+  int32_t  heuristicCost;
+  int32_t  maxTravelTime;
+  // time between loading and the end of unloading of a delivery
+  int32_t  timeMax;
+  // length of one time unit in time units of the planning file, 1 unless coarsened
+  int32_t  timeScale;
+  int64_t  baseTimeStamp;
+
+  uint64_t arenaSize;
+  // offset from the start of the arena and size in bytes of every column
+  uint64_t offset[IC_NUM_COLUMNS];
+  uint64_t size[IC_NUM_COLUMNS];
+};
+
+static inline uint64_t alignArena(uint64_t v) {
+  return (v + ARENA_ALIGNMENT - 1) & ~(uint64_t)(ARENA_ALIGNMENT - 1);
+}
+
+#endif
@@ -0,0 +1,294 @@
+/*
+ * LNS.cpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#include "LNS.hpp"
+#include "RMC.hpp"
+
+#include <gecode/search.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+/// Time budget if no time limit is given, in ms
+static const unsigned long LNS_DEFAULT_TIME = 60000;
+
+/// Bounds and initial value of the neighbourhood size, as fraction of the vehicles or orders
+static const double LNS_MIN_SIZE  = 0.02;
+static const double LNS_MAX_SIZE  = 0.5;
+static const double LNS_INIT_SIZE = 0.1;
+
+/// Factors applied to the size if a neighbourhood was searched completely or hit the fail limit
+static const double LNS_GROW   = 1.1;
+static const double LNS_SHRINK = 0.95;
+
+enum {
+  NB_VEHICLES,     ///< all deliveries of some vehicles
+  NB_TIME_WINDOW,  ///< all deliveries of the orders starting in a time window
+  NB_STATION,      ///< consecutive deliveries loaded at one station
+  NB_NUM
+};
+
+static const char *const NB_NAMES[NB_NUM] = { "vehicles", "window", "station" };
+
+/// Fail limit of one neighbourhood, and the time budget of the whole search
+class LNSStop : public Search::Stop {
+public:
+  LNSStop(unsigned long fail, Support::Timer &timer, unsigned long time)
+  : _fail(fail), _timer(timer), _time(time)
+  {}
+
+  virtual bool stop(const Search::Statistics &s, const Search::Options&)
+  {
+    return (_fail > 0 && s.fail > _fail) || _timer.stop() > _time;
+  }
+
+private:
+  unsigned long _fail;
+  Support::Timer &_timer;
+  unsigned long _time;
+};
+
+class LNS {
+public:
+  LNS(const RMCOptions &opt);
+
+  void run();
+
+private:
+  /// Relax a neighbourhood of the incumbent of the given kind, returns false if it is empty
+  bool relax(int kind, Relaxation &relaxation);
+
+  /// Relax all deliveries of the vehicle and let it serve other deliveries
+  void relaxVehicle(int vehicle, Relaxation &relaxation);
+
+  /// Relax a delivery of the incumbent, the other deliveries of its vehicle may move in time
+  void relaxDelivery(int idx, Relaxation &relaxation);
+
+  /// Number of vehicles or orders in a neighbourhood of the current size
+  int size(int count) const;
+
+  const RMCOptions &_opt;
+  const RMCInput &_input;
+
+  Rnd _rnd;
+
+  // fraction of the vehicles or orders to relax
+  double _size;
+
+  Schedule _incumbent;
+
+  // orders sorted by start time
+  std::vector<int> _ordersByStart;
+};
+
+/// Sort orders by start time
+struct StartLess {
+  const int *start;
+
+  StartLess(const int *s) : start(s) {}
+
+  bool operator()(int a, int b) const {
+    return start[a] < start[b];
+  }
+};
+
+/// Sort deliveries by loading time
+struct LoadLess {
+  const std::vector<ScheduledDelivery> &deliveries;
+
+  LoadLess(const std::vector<ScheduledDelivery> &d) : deliveries(d) {}
+
+  bool operator()(int a, int b) const {
+    return deliveries[a].tLoad < deliveries[b].tLoad;
+  }
+};
+
+LNS::LNS(const RMCOptions &opt)
+: _opt(opt), _input(opt.getInput()), _rnd(opt.seed()), _size(LNS_INIT_SIZE)
+{
+  for (int i = 0; i < _input.getNumOrders(); i++) {
+    _ordersByStart.push_back(i);
+  }
+  std::stable_sort(_ordersByStart.begin(), _ordersByStart.end(), StartLess(_input.getOrderStartTimes()));
+}
+
+int LNS::size(int count) const
+{
+  return std::max(1, std::min(count, (int) std::ceil(_size * count)));
+}
+
+void LNS::relaxVehicle(int vehicle, Relaxation &relaxation)
+{
+  relaxation.vehicles[vehicle] = true;
+}
+
+void LNS::relaxDelivery(int idx, Relaxation &relaxation)
+{
+  relaxation.deliveries[idx] = true;
+}
+
+bool LNS::relax(int kind, Relaxation &relaxation)
+{
+  const std::vector<ScheduledDelivery> &deliveries = _incumbent.getDeliveries();
+  int numV = _input.getNumVehicles();
+  int numO = _input.getNumOrders();
+
+  relaxation.deliveries.assign(deliveries.size(), false);
+  relaxation.vehicles.assign(numV, false);
+
+  bool relaxed = false;
+  switch (kind) {
+  case NB_VEHICLES: {
+    if (numV == 0) break;
+    // partial shuffle to draw distinct vehicles
+    std::vector<int> vehicles(numV);
+    for (int i = 0; i < numV; i++) vehicles[i] = i;
+    int k = size(numV);
+    for (int i = 0; i < k; i++) {
+      std::swap(vehicles[i], vehicles[i + _rnd(numV - i)]);
+      relaxVehicle(vehicles[i], relaxation);
+      relaxed = true;
+    }
+    break;
+  }
+  case NB_TIME_WINDOW: {
+    if (numO == 0) break;
+    int k = size(numO);
+    int first = _rnd(numO - k + 1);
+    std::vector<bool> orders(numO, false);
+    for (int i = first; i < first + k; i++) {
+      orders[_ordersByStart[i]] = true;
+    }
+    for (size_t j = 0; j < deliveries.size(); j++) {
+      if (orders[deliveries[j].order]) {
+        relaxDelivery(j, relaxation);
+        relaxed = true;
+      }
+    }
+    break;
+  }
+  case NB_STATION: {
+    if (_input.getNumStations() == 0) break;
+    int station = _rnd(_input.getNumStations());
+    std::vector<int> loads;
+    for (size_t j = 0; j < deliveries.size(); j++) {
+      if (deliveries[j].station == station) loads.push_back(j);
+    }
+    if (loads.empty()) break;
+    // consecutive loadings at the station
+    std::stable_sort(loads.begin(), loads.end(), LoadLess(deliveries));
+    int k = size(loads.size());
+    int first = _rnd(loads.size() - k + 1);
+    for (int i = first; i < first + k; i++) {
+      relaxDelivery(loads[i], relaxation);
+      relaxed = true;
+    }
+    break;
+  }
+  }
+
+  return relaxed;
+}
+
+void LNS::run()
+{
+  Support::Timer timer;
+  timer.start();
+  unsigned long budget = _opt.time() > 0 ? _opt.time() : LNS_DEFAULT_TIME;
+
+  RMCScript *root = RMCScript::create(_opt);
+  if (root->status() == SS_FAILED) {
+    std::cout << "No solution" << std::endl;
+    delete root;
+    return;
+  }
+
+  Search::Options so;
+  so.threads = 1;
+  so.c_d = _opt.c_d();
+  so.a_d = _opt.a_d();
+
+  // first solution, without fail limit
+  RMCScript *best = NULL;
+  {
+    LNSStop stop(0, timer, budget);
+    so.stop = &stop;
+    BAB<RMCScript> engine(root, so);
+    best = engine.next();
+  }
+  if (!best) {
+    std::cout << "LNS: no first solution found" << std::endl;
+    delete root;
+    return;
+  }
+  best->getSchedule(_incumbent);
+  std::cout << "LNS: first solution " << best->cost() << " after " << timer.stop() << " ms" << std::endl;
+
+  unsigned long iterations = 0;
+  std::vector<unsigned long> tries(NB_NUM, 0);
+  std::vector<unsigned long> improvements(NB_NUM, 0);
+
+  LNSStop stop(_opt.lnsFail(), timer, budget);
+  so.stop = &stop;
+
+  while (timer.stop() < budget) {
+    int kind = _rnd(NB_NUM);
+    Relaxation relaxation;
+    if (!relax(kind, relaxation)) continue;
+
+    iterations++;
+    tries[kind]++;
+
+    RMCScript *s = static_cast<RMCScript*>(root->clone());
+    s->relax(_incumbent, relaxation);
+    s->constrain(*best);
+
+    BAB<RMCScript> engine(s, so);
+    delete s;
+
+    RMCScript *better = NULL;
+    while (RMCScript *t = engine.next()) {
+      delete better;
+      better = t;
+    }
+
+    if (better) {
+      delete best;
+      best = better;
+      best->getSchedule(_incumbent);
+      improvements[kind]++;
+      std::cout << "LNS iteration " << iterations << ": cost " << best->cost() << " (" << NB_NAMES[kind]
+                << ", size " << _size << ", " << timer.stop() << " ms)" << std::endl;
+    } else if (engine.stopped()) {
+      // too large to search within the fail limit
+      _size = std::max(LNS_MIN_SIZE, _size * LNS_SHRINK);
+    } else {
+      // nothing better nearby, look further
+      _size = std::min(LNS_MAX_SIZE, _size * LNS_GROW);
+    }
+  }
+
+  std::cout << std::endl;
+  best->print(std::cout);
+  std::cout << std::endl << "Cost: " << best->cost() << std::endl;
+  std::cout << "LNS: " << iterations << " iterations in " << timer.stop() << " ms" << std::endl;
+  for (int k = 0; k < NB_NUM; k++) {
+    std::cout << "  " << NB_NAMES[k] << ": " << improvements[k] << " improvements in " << tries[k] << " tries"
+              << std::endl;
+  }
+
+  delete best;
+  delete root;
+}
+
+void solveLNS(const RMCOptions &opt)
+{
+  LNS lns(opt);
+  lns.run();
+}
@@ -0,0 +1,22 @@
+/*
+ * LNS.hpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#ifndef LNS_HPP_
+#define LNS_HPP_
+
+class RMCOptions;
+
+/**
+ * Large neighbourhood search: find a first solution, then repeatedly relax a neighbourhood of
+ * the incumbent and search it for a cheaper solution with opt.lnsFail() as fail limit. The
+ * neighbourhoods are all deliveries of some random vehicles, of the orders starting in a random
+ * time window, or from a random station. Their size adapts to how the searches end. Runs for
+ * opt.time() milliseconds, or one minute if there is no time limit, and prints the best solution.
+ */
+void solveLNS(const RMCOptions &opt);
+
+#endif
@@ -0,0 +1,251 @@
+/*
+ * OrderSequence.cpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#include "OrderSequence.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <vector>
+
+/// Apply a modification event, fail the propagator or note the change
+#define SEQUENCE_MODIFY(me) do {               \
+    ModEvent me_ = (me);                       \
+    GECODE_ME_CHECK(me_);                      \
+    changed = changed || me_modified(me_);     \
+  } while (0)
+
+class OrderSequence : public Propagator {
+protected:
+  ViewArray<Int::IntView> _orders;
+  ViewArray<Int::BoolView> _used;
+  ViewArray<Int::IntView> _tUnload;
+  ViewArray<Int::IntView> _unloading;
+  ViewArray<Int::IntView> _lateness;
+  ViewArray<Int::IntView> _lag;
+
+  SharedArray<int> _startTimes;
+
+  OrderSequence(Space &home, bool share, OrderSequence &p)
+  : Propagator(home, share, p)
+  {
+    _orders.update(home, share, p._orders);
+    _used.update(home, share, p._used);
+    _tUnload.update(home, share, p._tUnload);
+    _unloading.update(home, share, p._unloading);
+    _lateness.update(home, share, p._lateness);
+    _lag.update(home, share, p._lag);
+    _startTimes.update(home, share, p._startTimes);
+  }
+
+  /// Bounds of the deliveries of one order
+  struct Deliveries {
+    // slots that may deliver to the order, and slots that surely do
+    int possible;
+    int sure;
+    // earliest unloading of any possible slot
+    long long firstMin;
+    // latest unloading of the first, and earliest unloading of the last sure slot
+    long long sureFirstMax;
+    long long sureLastMin;
+    // longest total and shortest single unloading over all possible slots
+    long long unloadingMaxSum;
+    long long unloadingMin;
+    // unloading start and duration of all sure slots, if they are all assigned
+    bool fixed;
+    std::vector< std::pair<int,int> > unloads;
+
+    void clear() {
+      possible = sure = 0;
+      firstMin = sureFirstMax = unloadingMin = LLONG_MAX;
+      sureLastMin = LLONG_MIN;
+      unloadingMaxSum = 0;
+      fixed = true;
+      unloads.clear();
+    }
+  };
+
+public:
+  OrderSequence(Home home, ViewArray<Int::IntView> &orders, ViewArray<Int::BoolView> &used,
+                ViewArray<Int::IntView> &tUnload, ViewArray<Int::IntView> &unloading,
+                ViewArray<Int::IntView> &lateness, ViewArray<Int::IntView> &lag,
+                const SharedArray<int> &startTimes)
+  : Propagator(home), _orders(orders), _used(used), _tUnload(tUnload), _unloading(unloading),
+    _lateness(lateness), _lag(lag), _startTimes(startTimes)
+  {
+    _orders.subscribe(home, *this, Int::PC_INT_DOM);
+    _used.subscribe(home, *this, Int::PC_BOOL_VAL);
+    _tUnload.subscribe(home, *this, Int::PC_INT_BND);
+    _unloading.subscribe(home, *this, Int::PC_INT_BND);
+    _lateness.subscribe(home, *this, Int::PC_INT_BND);
+    _lag.subscribe(home, *this, Int::PC_INT_BND);
+  }
+
+  static ExecStatus post(Home home, ViewArray<Int::IntView> &orders, ViewArray<Int::BoolView> &used,
+                         ViewArray<Int::IntView> &tUnload, ViewArray<Int::IntView> &unloading,
+                         ViewArray<Int::IntView> &lateness, ViewArray<Int::IntView> &lag,
+                         const SharedArray<int> &startTimes)
+  {
+    for (int d = 0; d < orders.size(); d++) {
+      GECODE_ME_CHECK(orders[d].gq(home, 0));
+      GECODE_ME_CHECK(orders[d].le(home, lateness.size()));
+    }
+    for (int i = 0; i < lag.size(); i++) {
+      GECODE_ME_CHECK(lag[i].gq(home, 0));
+    }
+    (void) new (home) OrderSequence(home, orders, used, tUnload, unloading, lateness, lag, startTimes);
+    return ES_OK;
+  }
+
+  virtual Actor* copy(Space &home, bool share)
+  {
+    return new (home) OrderSequence(home, share, *this);
+  }
+
+  virtual PropCost cost(const Space&, const ModEventDelta&) const
+  {
+    return PropCost::linear(PropCost::HI, _orders.size() + _lateness.size());
+  }
+
+  virtual size_t dispose(Space &home)
+  {
+    _orders.cancel(home, *this, Int::PC_INT_DOM);
+    _used.cancel(home, *this, Int::PC_BOOL_VAL);
+    _tUnload.cancel(home, *this, Int::PC_INT_BND);
+    _unloading.cancel(home, *this, Int::PC_INT_BND);
+    _lateness.cancel(home, *this, Int::PC_INT_BND);
+    _lag.cancel(home, *this, Int::PC_INT_BND);
+    _startTimes.~SharedArray<int>();
+    (void) Propagator::dispose(home);
+    return sizeof(*this);
+  }
+
+  virtual ExecStatus propagate(Space &home, const ModEventDelta&)
+  {
+    int n = _orders.size();
+    int m = _lateness.size();
+
+    // Bounds are collected at the start of a pass. Modifications within the pass only tighten the
+    // views, so the bounds get weaker but stay sound.
+    std::vector<Deliveries> orders(m);
+    std::vector<int> removed;
+
+    bool changed;
+    do {
+      changed = false;
+
+      for (int i = 0; i < m; i++) {
+        orders[i].clear();
+      }
+      for (int d = 0; d < n; d++) {
+        if (_used[d].zero()) continue;
+
+        bool sure = _used[d].one() && _orders[d].assigned();
+        for (Int::ViewValues<Int::IntView> i(_orders[d]); i(); ++i) {
+          Deliveries &o = orders[i.val()];
+          o.possible++;
+          o.firstMin = std::min(o.firstMin, (long long) _tUnload[d].min());
+          o.unloadingMaxSum += _unloading[d].max();
+          o.unloadingMin = std::min(o.unloadingMin, (long long) _unloading[d].min());
+
+          if (!sure) continue;
+          o.sure++;
+          o.sureFirstMax = std::min(o.sureFirstMax, (long long) _tUnload[d].max());
+          o.sureLastMin = std::max(o.sureLastMin, (long long) _tUnload[d].min());
+          if (_tUnload[d].assigned() && _unloading[d].assigned()) {
+            o.unloads.push_back(std::make_pair(_tUnload[d].val(), _unloading[d].val()));
+          } else {
+            o.fixed = false;
+          }
+        }
+      }
+
+      for (int i = 0; i < m; i++) {
+        Deliveries &o = orders[i];
+        if (o.possible == 0) return ES_FAILED;
+
+        // The first delivery is one of the possible slots, and not later than any sure slot
+        SEQUENCE_MODIFY(_lateness[i].gq(home, o.firstMin - _startTimes[i]));
+        if (o.sure > 0) {
+          SEQUENCE_MODIFY(_lateness[i].lq(home, o.sureFirstMax - _startTimes[i]));
+        }
+
+        if (o.possible != o.sure) continue;
+
+        // All deliveries are known. The time between the first and the last unloading is the lag
+        // plus the unloading of all deliveries but the last.
+        if (o.fixed) {
+          std::sort(o.unloads.begin(), o.unloads.end());
+          long long lag = 0;
+          for (size_t d = 1; d < o.unloads.size(); d++) {
+            lag += o.unloads[d].first - o.unloads[d-1].first - o.unloads[d-1].second;
+          }
+          SEQUENCE_MODIFY(_lateness[i].eq(home, o.unloads[0].first - _startTimes[i]));
+          SEQUENCE_MODIFY(_lag[i].eq(home, lag));
+        } else {
+          SEQUENCE_MODIFY(_lag[i].gq(home, o.sureLastMin - o.sureFirstMax - (o.unloadingMaxSum - o.unloadingMin)));
+        }
+      }
+
+      for (int d = 0; d < n; d++) {
+        if (_used[d].zero()) continue;
+
+        if (_used[d].one() && _orders[d].assigned()) {
+          int k = _orders[d].val();
+          const Deliveries &o = orders[k];
+
+          // Not before the first delivery, and not further from the other sure deliveries than
+          // the lag and the unloading in between allow
+          long long span = _lag[k].max() + o.unloadingMaxSum - o.unloadingMin;
+          SEQUENCE_MODIFY(_tUnload[d].gq(home, _startTimes[k] + _lateness[k].min()));
+          SEQUENCE_MODIFY(_tUnload[d].gq(home, o.sureLastMin - span));
+          SEQUENCE_MODIFY(_tUnload[d].lq(home, o.sureFirstMax + span));
+          continue;
+        }
+
+        // Orders whose first delivery can not be unloaded as late as this slot
+        removed.clear();
+        for (Int::ViewValues<Int::IntView> i(_orders[d]); i(); ++i) {
+          if (_tUnload[d].max() < _startTimes[i.val()] + _lateness[i.val()].min()) {
+            removed.push_back(i.val());
+          }
+        }
+        if (removed.empty()) continue;
+
+        if (_used[d].one()) {
+          for (size_t j = 0; j < removed.size(); j++) {
+            SEQUENCE_MODIFY(_orders[d].nq(home, removed[j]));
+          }
+        } else if (_orders[d].assigned()) {
+          SEQUENCE_MODIFY(_used[d].zero(home));
+        }
+      }
+    } while (changed);
+
+    if (_orders.assigned() && _used.assigned() && _tUnload.assigned() && _unloading.assigned() &&
+        _lateness.assigned() && _lag.assigned()) {
+      return home.ES_SUBSUMED(*this);
+    }
+    return ES_FIX;
+  }
+};
+
+void orderSequence(Home home, const IntVarArgs &orders, const BoolVarArgs &used,
+                   const IntVarArgs &tUnload, const IntVarArgs &unloading, const IntArgs &startTimes,
+                   const IntVarArgs &lateness, const IntVarArgs &lag)
+{
+  if (home.failed()) return;
+
+  ViewArray<Int::IntView> o(home, orders);
+  ViewArray<Int::BoolView> u(home, used);
+  ViewArray<Int::IntView> t(home, tUnload);
+  ViewArray<Int::IntView> dt(home, unloading);
+  ViewArray<Int::IntView> l(home, lateness);
+  ViewArray<Int::IntView> g(home, lag);
+
+  GECODE_ES_FAIL(OrderSequence::post(home, o, u, t, dt, l, g, SharedArray<int>(startTimes)));
+}
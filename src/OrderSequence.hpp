@@ -0,0 +1,28 @@
+/*
+ * OrderSequence.hpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#ifndef ORDERSEQUENCE_HPP_
+#define ORDERSEQUENCE_HPP_
+
+#include <gecode/int.hh>
+
+using namespace Gecode;
+
+/**
+ * Lateness and time lag of every order i over the sequence of its deliveries, i.e. of all used
+ * slots d with orders[d] == i, sorted by their unloading start tUnload[d]:
+ *
+ *   lateness[i] = tUnload of the first delivery - startTimes[i]
+ *   lag[i]      = sum over consecutive deliveries p, q of tUnload[q] - tUnload[p] - unloading[p]
+ *
+ * Every order must have at least one delivery.
+ */
+void orderSequence(Home home, const IntVarArgs &orders, const BoolVarArgs &used,
+                   const IntVarArgs &tUnload, const IntVarArgs &unloading, const IntArgs &startTimes,
+                   const IntVarArgs &lateness, const IntVarArgs &lag);
+
+#endif
@@ -0,0 +1,340 @@
+/*
+ * Parallel.cpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#include "Parallel.hpp"
+#include "RMC.hpp"
+
+#include <gecode/search.hh>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Subtrees per thread in deterministic mode, more subtrees balance the load better
+static const unsigned int SUBTREES_PER_THREAD = 8;
+
+/**
+ * Stop object enforcing the node, fail and time limits that also collects the statistics of all
+ * search threads. Gecode's engines call stop() from every worker with the statistics of that
+ * worker (the restart engine with a temporary sum), so the latest statistics are copied per thread.
+ */
+class ThreadStatistics : public Search::Stop {
+public:
+  ThreadStatistics(unsigned long node, unsigned long fail, unsigned long time)
+  : _node(node), _fail(fail), _time(time)
+  {
+    _timer.start();
+  }
+
+  virtual bool stop(const Search::Statistics &s, const Search::Options&)
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      std::thread::id thread = std::this_thread::get_id();
+      if (_workers.find(thread) == _workers.end()) {
+        _order.push_back(thread);
+      }
+      _workers[thread] = s;
+    }
+    return (_node > 0 && s.node > _node) || (_fail > 0 && s.fail > _fail) ||
+           (_time > 0 && _timer.stop() > _time);
+  }
+
+  /// Latest statistics of every thread seen so far, in the order the threads were first seen
+  void get(std::vector<Search::Statistics> &stats)
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    stats.clear();
+    for (size_t i = 0; i < _order.size(); i++) {
+      stats.push_back(_workers[_order[i]]);
+    }
+  }
+
+private:
+  unsigned long _node;
+  unsigned long _fail;
+  unsigned long _time;
+  Support::Timer _timer;
+
+  // protects _workers and _order
+  std::mutex _mutex;
+  std::map<std::thread::id, Search::Statistics> _workers;
+  std::vector<std::thread::id> _order;
+};
+
+static void printSolution(const RMCScript &s)
+{
+  s.print(std::cout);
+  std::cout << "----------" << std::endl;
+}
+
+static void printSummary(const RMCScript *best, bool stopped, double time, const Search::Statistics &total,
+                         const std::vector<Search::Statistics> &threads)
+{
+  std::cout << std::endl;
+  if (best) {
+    std::cout << "Cost: " << best->cost() << (stopped ? "" : " (optimal)") << std::endl;
+  } else {
+    std::cout << (stopped ? "No solution found within the limits" : "No solution") << std::endl;
+  }
+  std::cout << "Search: " << time << " ms, " << total.node << " nodes, " << total.fail << " failures, "
+            << "peak depth " << total.depth;
+  if (total.restart > 0) {
+    std::cout << ", " << total.restart << " restarts, " << total.nogood << " no-goods";
+  }
+  std::cout << std::endl;
+  for (size_t i = 0; i < threads.size(); i++) {
+    std::cout << "  thread " << i << ": " << threads[i].node << " nodes, " << threads[i].fail << " failures, "
+              << "peak depth " << threads[i].depth << std::endl;
+  }
+}
+
+/**
+ * Cutoff sequence for the restart mode of the options, in failures, or NULL without restarts.
+ * The engine takes ownership of the cutoff.
+ */
+static Search::Cutoff *createCutoff(const RMCOptions &opt)
+{
+  switch (opt.restart()) {
+  case RM_CONSTANT:
+    return Search::Cutoff::constant(opt.restart_scale());
+  case RM_LINEAR:
+    return Search::Cutoff::linear(opt.restart_scale());
+  case RM_LUBY:
+    return Search::Cutoff::luby(opt.restart_scale());
+  case RM_GEOMETRIC:
+    return Search::Cutoff::geometric(opt.restart_scale(), opt.restart_base());
+  default:
+    break;
+  }
+  return NULL;
+}
+
+template<class Engine>
+static void runEngine(RMCScript *root, const Search::Options &so, ThreadStatistics &stop, Support::Timer &timer)
+{
+  Engine engine(root, so);
+  delete root;
+
+  RMCScript *best = NULL;
+  while (RMCScript *s = engine.next()) {
+    printSolution(*s);
+    delete best;
+    best = s;
+  }
+
+  std::vector<Search::Statistics> stats;
+  stop.get(stats);
+  printSummary(best, engine.stopped(), timer.stop(), engine.statistics(), stats);
+
+  delete best;
+}
+
+template<class Engine>
+static RMCScript *bestSolution(RMCScript *root, const Search::Options &so, Search::Statistics &stat, bool &stopped)
+{
+  Engine engine(root, so);
+  delete root;
+
+  RMCScript *best = NULL;
+  while (RMCScript *s = engine.next()) {
+    delete best;
+    best = s;
+  }
+  stat = engine.statistics();
+  stopped = engine.stopped();
+  return best;
+}
+
+RMCScript *searchBest(RMCScript *root, const RMCOptions &opt, const Search::Options &options,
+                      Search::Statistics &stat, bool &stopped)
+{
+  Search::Options so(options);
+  so.c_d = opt.c_d();
+  so.a_d = opt.a_d();
+  so.cutoff = createCutoff(opt);
+
+  if (so.cutoff) {
+    so.nogoods_limit = opt.nogoods() ? opt.nogoods_limit() : 0;
+    return bestSolution< RBS<BAB,RMCScript> >(root, so, stat, stopped);
+  }
+  return bestSolution< BAB<RMCScript> >(root, so, stat, stopped);
+}
+
+/// Gecode's parallel BAB engine, the threads steal work from each other. With a restart mode the
+/// engine restarts from the root whenever the cutoff is reached, keeping the best cost, and records
+/// no-goods from the abandoned search paths if opt.nogoods() is set.
+static void solveShared(const RMCOptions &opt, unsigned int threads)
+{
+  Support::Timer timer;
+  timer.start();
+
+  RMCScript *root = RMCScript::create(opt);
+
+  ThreadStatistics stop(opt.node(), opt.fail(), opt.time());
+  Search::Options so;
+  so.threads = threads;
+  so.c_d = opt.c_d();
+  so.a_d = opt.a_d();
+  so.stop = &stop;
+  so.cutoff = createCutoff(opt);
+
+  if (so.cutoff) {
+    so.nogoods_limit = opt.nogoods() ? opt.nogoods_limit() : 0;
+    runEngine< RBS<BAB,RMCScript> >(root, so, stop, timer);
+  } else {
+    runEngine< BAB<RMCScript> >(root, so, stop, timer);
+  }
+}
+
+/**
+ * Split the search tree breadth first until there are at least count open nodes or the tree is
+ * exhausted. The subtrees are in the order of a left to right traversal of every level.
+ */
+static void splitSearch(RMCScript *root, size_t count, std::vector<RMCScript*> &subtrees)
+{
+  std::deque<RMCScript*> open;
+  open.push_back(root);
+
+  while (!open.empty() && open.size() + subtrees.size() < count) {
+    RMCScript *s = open.front();
+    open.pop_front();
+
+    switch (s->status()) {
+    case SS_FAILED:
+      delete s;
+      break;
+    case SS_SOLVED:
+      subtrees.push_back(s);
+      break;
+    case SS_BRANCH: {
+      const Choice *c = s->choice();
+      unsigned int alternatives = c->alternatives();
+      for (unsigned int a = 0; a < alternatives; a++) {
+        // the subtrees are solved in different threads, so clones must not share data
+        RMCScript *t = (a + 1 < alternatives) ? static_cast<RMCScript*>(s->clone(false)) : s;
+        t->commit(*c, a);
+        open.push_back(t);
+      }
+      delete c;
+      break;
+    }
+    }
+  }
+
+  subtrees.insert(subtrees.end(), open.begin(), open.end());
+}
+
+struct SubtreeResult {
+  RMCScript *best;
+  Search::Statistics stat;
+  bool stopped;
+
+  SubtreeResult() : best(NULL), stopped(false) {}
+};
+
+/// Solve one subtree with a sequential engine, node and fail limits apply to the subtree
+static void solveSubtree(RMCScript *subtree, const RMCOptions &opt, SubtreeResult &result)
+{
+  ThreadStatistics stop(opt.node(), opt.fail(), 0);
+  Search::Options so;
+  so.threads = 1;
+  so.c_d = opt.c_d();
+  so.a_d = opt.a_d();
+  so.stop = &stop;
+
+  BAB<RMCScript> engine(subtree, so);
+  delete subtree;
+
+  while (RMCScript *s = engine.next()) {
+    delete result.best;
+    result.best = s;
+  }
+  result.stat = engine.statistics();
+  result.stopped = engine.stopped();
+}
+
+/// Fixed subtrees solved in waves of one subtree per thread, the best cost is exchanged between waves
+static void solveDeterministic(const RMCOptions &opt, unsigned int threads)
+{
+  Support::Timer timer;
+  timer.start();
+
+  std::vector<RMCScript*> subtrees;
+  splitSearch(RMCScript::create(opt), threads * SUBTREES_PER_THREAD, subtrees);
+
+  std::vector<Search::Statistics> stats(threads);
+  Search::Statistics total;
+  RMCScript *best = NULL;
+  bool stopped = false;
+
+  size_t next = 0;
+  while (next < subtrees.size()) {
+    if (opt.time() > 0 && timer.stop() > opt.time()) {
+      stopped = true;
+      break;
+    }
+
+    size_t wave = std::min<size_t>(threads, subtrees.size() - next);
+    std::vector<SubtreeResult> results(wave);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < wave; i++) {
+      if (best) {
+        subtrees[next + i]->constrain(*best);
+      }
+      workers.push_back(std::thread(solveSubtree, subtrees[next + i], std::cref(opt), std::ref(results[i])));
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+      workers[i].join();
+    }
+
+    // take the results in the order of the subtrees, so that ties are broken the same way in every run
+    for (size_t i = 0; i < wave; i++) {
+      stats[i] += results[i].stat;
+      total += results[i].stat;
+      stopped = stopped || results[i].stopped;
+
+      RMCScript *s = results[i].best;
+      if (s && (!best || s->cost().val() < best->cost().val())) {
+        printSolution(*s);
+        delete best;
+        best = s;
+      } else {
+        delete s;
+      }
+    }
+    next += wave;
+  }
+
+  for (size_t i = next; i < subtrees.size(); i++) {
+    delete subtrees[i];
+  }
+
+  printSummary(best, stopped, timer.stop(), total, stats);
+
+  delete best;
+}
+
+void solveParallel(const RMCOptions &opt)
+{
+  Search::Options so;
+  so.threads = opt.threads();
+  unsigned int threads = std::max(1, static_cast<int>(so.expand().threads));
+
+  std::cout << "Search threads: " << threads << (opt.deterministic() ? " (deterministic)" : "") << std::endl;
+
+  if (opt.deterministic()) {
+    solveDeterministic(opt, threads);
+  } else {
+    solveShared(opt, threads);
+  }
+}
@@ -0,0 +1,43 @@
+/*
+ * Parallel.hpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#ifndef PARALLEL_HPP_
+#define PARALLEL_HPP_
+
+#include <gecode/search.hh>
+
+using namespace Gecode;
+
+class RMCOptions;
+class RMCScript;
+
+/**
+ * Solve the whole instance with opt.threads() search threads, print every improving solution
+ * and the statistics of every thread.
+ *
+ * By default the threads share the work with Gecode's parallel BAB engine, which steals work
+ * between threads and is therefore not reproducible. With a restart mode (-restart) it is wrapped
+ * in a restart engine with the cutoffs and no-goods of the options.
+ *
+ * With opt.deterministic() the search tree is split into a fixed list of subtrees instead. They
+ * are solved in waves of one subtree per thread with sequential BAB engines without restarts, and
+ * the best cost is only exchanged between waves. The result does not depend on timing, as long as
+ * the search ends by itself or by the fail limit (which applies to every subtree) rather than by
+ * the time limit (which is checked between waves). A time limit without a fail limit would not
+ * bound the first wave, so main rejects that combination.
+ */
+void solveParallel(const RMCOptions &opt);
+
+/**
+ * Best solution of a model with the search engine of so, restarting and recording no-goods as the
+ * options ask for. Takes ownership of root. Returns NULL if there is no solution; stat and stopped
+ * describe the search.
+ */
+RMCScript *searchBest(RMCScript *root, const RMCOptions &opt, const Search::Options &so,
+                      Search::Statistics &stat, bool &stopped);
+
+#endif
@@ -0,0 +1,269 @@
+/*
+ * Portfolio.cpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ *
+ * Portfolio of branching strategies. Every strategy searches its own copy of the model in its
+ * own thread, the best cost found so far is published through an atomic. A propagator on the
+ * cost variable enforces it in all models, and every strategy drops solutions that are not
+ * better than it.
+ */
+
+#include "Portfolio.hpp"
+#include "RMC.hpp"
+
+#include <gecode/search.hh>
+
+#include <atomic>
+#include <climits>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// cost < bound, for a bound that is lowered from outside the space
+class SharedBound : public Propagator {
+protected:
+  Int::IntView _cost;
+  const std::atomic<int> *_bound;
+
+  SharedBound(Space &home, bool share, SharedBound &p)
+  : Propagator(home, share, p), _bound(p._bound)
+  {
+    _cost.update(home, share, p._cost);
+  }
+
+public:
+  SharedBound(Home home, Int::IntView cost, const std::atomic<int> *bound)
+  : Propagator(home), _cost(cost), _bound(bound)
+  {
+    _cost.subscribe(home, *this, Int::PC_INT_BND);
+  }
+
+  static ExecStatus post(Home home, Int::IntView cost, const std::atomic<int> *bound)
+  {
+    (void) new (home) SharedBound(home, cost, bound);
+    return ES_OK;
+  }
+
+  virtual Actor* copy(Space &home, bool share)
+  {
+    return new (home) SharedBound(home, share, *this);
+  }
+
+  virtual PropCost cost(const Space&, const ModEventDelta&) const
+  {
+    return PropCost::unary(PropCost::LO);
+  }
+
+  virtual size_t dispose(Space &home)
+  {
+    _cost.cancel(home, *this, Int::PC_INT_BND);
+    (void) Propagator::dispose(home);
+    return sizeof(*this);
+  }
+
+  // runs only when the bounds of the cost change, until then the space keeps searching under the
+  // bound it saw last. Portfolio::search drops the solutions that are no longer better.
+  virtual ExecStatus propagate(Space &home, const ModEventDelta&)
+  {
+    int bound = _bound->load(std::memory_order_relaxed);
+    if (bound < INT_MAX) {
+      GECODE_ME_CHECK(_cost.le(home, bound));
+    }
+    if (_cost.assigned()) {
+      return home.ES_SUBSUMED(*this);
+    }
+    return ES_FIX;
+  }
+};
+
+static void sharedBound(Home home, IntVar cost, const std::atomic<int> &bound)
+{
+  if (home.failed()) return;
+
+  GECODE_ES_FAIL(SharedBound::post(home, Int::IntView(cost), &bound));
+}
+
+/// Node, fail and time limits of one strategy, and the end of the whole portfolio
+class PortfolioStop : public Search::Stop {
+public:
+  PortfolioStop(const std::atomic<bool> &done, unsigned long node, unsigned long fail, unsigned long time)
+  : _done(done), _node(node), _fail(fail), _time(time)
+  {
+    _timer.start();
+  }
+
+  virtual bool stop(const Search::Statistics &s, const Search::Options&)
+  {
+    return _done.load(std::memory_order_relaxed) ||
+           (_node > 0 && s.node > _node) || (_fail > 0 && s.fail > _fail) ||
+           (_time > 0 && _timer.stop() > _time);
+  }
+
+private:
+  const std::atomic<bool> &_done;
+  unsigned long _node;
+  unsigned long _fail;
+  unsigned long _time;
+  Support::Timer _timer;
+};
+
+struct Strategy {
+  int branching;
+  RMCScript *root;
+  RMCScript *best;
+  // time in ms after the start when best was found
+  double foundAt;
+  Search::Statistics stat;
+  // true if the strategy exhausted its search tree
+  bool complete;
+
+  Strategy() : branching(BRANCH_STATIC), root(NULL), best(NULL), foundAt(0), complete(false) {}
+};
+
+class Portfolio {
+public:
+  Portfolio(const RMCOptions &opt) : _opt(opt), _bound(INT_MAX), _done(false) {}
+
+  /// Create the models of all strategies, bounded by the shared cost
+  void create(RMCOptions &opt, std::vector<Strategy> &strategies);
+
+  void run(std::vector<Strategy> &strategies);
+
+private:
+  void search(Strategy &strategy);
+
+  const RMCOptions &_opt;
+
+  // best cost over all strategies
+  std::atomic<int> _bound;
+  // set when a strategy has proven optimality
+  std::atomic<bool> _done;
+
+  Support::Timer _timer;
+
+  // protects the output
+  std::mutex _mutex;
+};
+
+void Portfolio::create(RMCOptions &opt, std::vector<Strategy> &strategies)
+{
+  int branching = opt.branching();
+
+  strategies.clear();
+  for (int b = 0; b < BRANCH_NUM; b++) {
+    // the order model has no tours to build in time order, it branches like BRANCH_TOURS
+    if (b == BRANCH_SGS && opt.model() == MODEL_ORDERS) continue;
+    
+    opt.branching(b);
+    Strategy strategy;
+    strategy.branching = b;
+    strategy.root = RMCScript::create(opt);
+    sharedBound(*strategy.root, strategy.root->cost(), _bound);
+    strategies.push_back(strategy);
+  }
+
+  opt.branching(branching);
+}
+
+void Portfolio::run(std::vector<Strategy> &strategies)
+{
+  _timer.start();
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < strategies.size(); i++) {
+    threads.push_back(std::thread(&Portfolio::search, this, std::ref(strategies[i])));
+  }
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+  }
+}
+
+void Portfolio::search(Strategy &strategy)
+{
+  PortfolioStop stop(_done, _opt.node(), _opt.fail(), _opt.time());
+  Search::Options so;
+  // the strategies already run in parallel
+  so.threads = 1;
+  so.c_d = _opt.c_d();
+  so.a_d = _opt.a_d();
+  so.stop = &stop;
+
+  BAB<RMCScript> engine(strategy.root, so);
+  delete strategy.root;
+  strategy.root = NULL;
+
+  while (RMCScript *s = engine.next()) {
+    int cost = s->cost().val();
+
+    // publish the cost, unless another strategy has found one at least as good in the meantime
+    int current = _bound.load();
+    bool improved = false;
+    while (cost < current && !(improved = _bound.compare_exchange_weak(current, cost))) {}
+    if (!improved) {
+      delete s;
+      continue;
+    }
+
+    delete strategy.best;
+    strategy.best = s;
+    strategy.foundAt = _timer.stop();
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::cout << "Strategy " << BRANCH_NAMES[strategy.branching] << ": cost " << cost
+              << " after " << strategy.foundAt << " ms" << std::endl;
+  }
+
+  strategy.stat = engine.statistics();
+  strategy.complete = !engine.stopped();
+  if (strategy.complete) {
+    _done = true;
+  }
+}
+
+void solvePortfolio(RMCOptions &opt)
+{
+  Portfolio portfolio(opt);
+
+  std::vector<Strategy> strategies;
+  portfolio.create(opt, strategies);
+  portfolio.run(strategies);
+
+  // cheapest solution, ties go to the strategy that found it first
+  const Strategy *winner = NULL;
+  bool optimal = false;
+  for (size_t i = 0; i < strategies.size(); i++) {
+    const Strategy &s = strategies[i];
+    optimal = optimal || s.complete;
+    if (!s.best) continue;
+    if (!winner || s.best->cost().val() < winner->best->cost().val() ||
+        (s.best->cost().val() == winner->best->cost().val() && s.foundAt < winner->foundAt)) {
+      winner = &s;
+    }
+  }
+
+  if (winner) {
+    std::cout << std::endl;
+    winner->best->print(std::cout);
+    std::cout << std::endl << "Cost: " << winner->best->cost() << (optimal ? " (optimal)" : "") << std::endl;
+    std::cout << "Winning strategy: " << BRANCH_NAMES[winner->branching]
+              << " after " << winner->foundAt << " ms" << std::endl;
+  } else {
+    std::cout << std::endl << (optimal ? "No solution" : "No solution found within the limits") << std::endl;
+  }
+
+  for (size_t i = 0; i < strategies.size(); i++) {
+    const Strategy &s = strategies[i];
+    std::cout << "  " << BRANCH_NAMES[s.branching] << ": ";
+    if (s.best) {
+      std::cout << "cost " << s.best->cost().val();
+    } else {
+      std::cout << "no solution";
+    }
+    std::cout << ", " << s.stat.node << " nodes, " << s.stat.fail << " failures"
+              << (s.complete ? ", complete" : "") << std::endl;
+    delete s.best;
+  }
+}
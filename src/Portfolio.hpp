@@ -0,0 +1,22 @@
+/*
+ * Portfolio.hpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#ifndef PORTFOLIO_HPP_
+#define PORTFOLIO_HPP_
+
+class RMCOptions;
+
+/**
+ * Run one sequential BAB search per branching strategy concurrently. Every cost found bounds
+ * the searches of all strategies, so the first strategy that exhausts its tree proves the best
+ * solution optimal and stops the others. Prints the best solution, the strategy that found it
+ * and the statistics of all strategies. The branching of opt is changed while the models are
+ * created and restored afterwards.
+ */
+void solvePortfolio(RMCOptions &opt);
+
+#endif
@@ -9,228 +9,810 @@
 
 #include "XMLDataTypes.hpp"
 #include "ReadXML.hpp"
+#include "InstanceLayout.hpp"
+#include "Greedy.hpp"
 
+#include <cstdio>
 #include <ctime>
 #include <cmath>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <map>
 
+#include <sys/mman.h>
+
+
+
+/// Mutable pointer to a column of an arena that is being filled
+static int *arenaColumn(InstanceHeader *header, InstanceColumn column)
+{
+  return (int*) ((char*) header + header->offset[column]);
+}
+
+RMCInput::RMCInput()
+: _numOrders(0), _numVehicles(0), _numStations(0), _numYards(0),
+  _maxDeliveries(0), _maxTimeStamp(0), _additiveTimeStamp(0), _heuristicCost(-1),
+  _maxTravelTime(0), _timeMax(DEFAULT_TIME_MAX), _timeScale(1), _baseTimeStamp(0),
+  _arena(0), _arenaSize(0), _arenaMapped(false)
+{
+  attachArena(0, 0, false);
+}
+
+RMCInput::~RMCInput()
+{
+  releaseArena();
+}
+
+InstanceHeader *RMCInput::allocateArena(int numO, int numV, int numS, int numY, size_t nameChars)
+{
+  int sizes[IC_NUM_COLUMNS] = {
+    numO, numO, numO, numO, numO, numO, numO, numO, numO, numO, numO, numO + 1,
+    numV, numV, numV, numV, numV, numV, numV, numV + 1,
+    numS,
+    numO * numV, numO * numV,
+    numY * numS, numY * numS,
+    numO + 1, numV + 1, numS + 1, numY + 1,
+    0
+  };
+  
+  InstanceHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, INSTANCE_MAGIC, sizeof(header.magic));
+  header.version     = INSTANCE_VERSION;
+  header.numOrders   = numO;
+  header.numVehicles = numV;
+  header.numStations = numS;
+  header.numYards    = numY;
+  
+  uint64_t offset = alignArena(sizeof(InstanceHeader));
+  for (int i = 0; i < IC_NUM_COLUMNS; i++) {
+    header.offset[i] = offset;
+    header.size[i] = (i == IC_NAME_CHARS) ? nameChars : sizes[i] * sizeof(int32_t);
+    offset = alignArena(offset + header.size[i]);
+  }
+  header.arenaSize = offset;
+  
+  void *arena = 0;
+  if (posix_memalign(&arena, ARENA_ALIGNMENT, header.arenaSize) != 0) {
+    return 0;
+  }
+  memset(arena, 0, header.arenaSize);
+  memcpy(arena, &header, sizeof(header));
+  
+  return (InstanceHeader*) arena;
+}
+
+void RMCInput::attachArena(char *arena, size_t size, bool mapped)
+{
+  _arena = arena;
+  _arenaSize = size;
+  _arenaMapped = mapped;
+  
+  const int *columns[IC_NUM_COLUMNS] = { 0 };
+  
+  if (arena) {
+    const InstanceHeader &header = *(const InstanceHeader*) arena;
+    
+    _numOrders     = header.numOrders;
+    _numVehicles   = header.numVehicles;
+    _numStations   = header.numStations;
+    _numYards      = header.numYards;
+    _maxDeliveries = header.maxDeliveries;
+    _maxTimeStamp  = header.maxTimeStamp;
+    _additiveTimeStamp = header.additiveTimeStamp;
+    _heuristicCost = header.heuristicCost;
+    _maxTravelTime = header.maxTravelTime;
+    _timeMax       = header.timeMax;
+    _timeScale     = header.timeScale;
+    _baseTimeStamp = header.baseTimeStamp;
+    
+    for (int i = 0; i < IC_NUM_COLUMNS; i++) {
+      columns[i] = (const int*) (arena + header.offset[i]);
+    }
+  } else {
+    _numOrders = _numVehicles = _numStations = _numYards = 0;
+    _maxDeliveries = _maxTimeStamp = _additiveTimeStamp = _maxTravelTime = 0;
+    _heuristicCost = -1;
+    _timeMax = DEFAULT_TIME_MAX;
+    _timeScale = 1;
+    _baseTimeStamp = 0;
+  }
+  
+  _orderStartTimes        = columns[IC_ORDER_START_TIMES];
+  _orderTotalVolumes      = columns[IC_ORDER_TOTAL_VOLUMES];
+  _orderReqDischargeRates = columns[IC_ORDER_DISCHARGE_RATES];
+  _orderReqPipeLength     = columns[IC_ORDER_PIPE_LENGTHS];
+  _orderSetupTimes        = columns[IC_ORDER_SETUP_TIMES];
+  _orderPreferredStations = columns[IC_ORDER_PREF_STATIONS];
+  _orderMaxVolumeAllowed  = columns[IC_ORDER_MAX_VOLUME];
+  _orderYards             = columns[IC_ORDER_YARDS];
+  _orderMaxDeliveries     = columns[IC_ORDER_MAX_DELIVERIES];
+  _orderMinDeliveries     = columns[IC_ORDER_MIN_DELIVERIES];
+  _orderDeadlines         = columns[IC_ORDER_DEADLINES];
+  _orderDeliveryOffsets   = columns[IC_ORDER_DELIVERY_OFFSETS];
+  _vehiclePumpLengths     = columns[IC_VEHICLE_PUMP_LENGTHS];
+  _vehicleDischargeRates  = columns[IC_VEHICLE_DISCHARGE_RATES];
+  _vehicleNormalVolumes   = columns[IC_VEHICLE_NORMAL_VOLUMES];
+  _vehicleMaxVolumes      = columns[IC_VEHICLE_MAX_VOLUMES];
+  _vehicleAvailableFrom   = columns[IC_VEHICLE_AVAILABLE];
+  _vehicleMaxDeliveries   = columns[IC_VEHICLE_MAX_DELIVERIES];
+  _vehicleClasses         = columns[IC_VEHICLE_CLASSES];
+  _vehicleDeliveryOffsets = columns[IC_VEHICLE_DELIVERY_OFFSETS];
+  _stationLoadTimes       = columns[IC_STATION_LOAD_TIMES];
+  _orderVehicleVolumes    = columns[IC_ORDER_VEHICLE_VOLUMES];
+  _orderVehicleCompatible = columns[IC_ORDER_VEHICLE_COMPATIBLE];
+  _travelTimesTo          = columns[IC_TRAVEL_TO];
+  _travelTimesFrom        = columns[IC_TRAVEL_FROM];
+  _orderNames             = columns[IC_ORDER_NAMES];
+  _vehicleNames           = columns[IC_VEHICLE_NAMES];
+  _stationNames           = columns[IC_STATION_NAMES];
+  _yardNames              = columns[IC_YARD_NAMES];
+  _nameChars              = (const char*) columns[IC_NAME_CHARS];
+}
+
+void RMCInput::releaseArena()
+{
+  if (_arena) {
+    if (_arenaMapped) {
+      munmap(_arena, _arenaSize);
+    } else {
+      free(_arena);
+    }
+  }
+  attachArena(0, 0, false);
+}
 
 int RMCInput::getStation(const std::string &code) const
 {
   if (code.empty()) return -1;
-  std::map<std::string, int>::const_iterator it = _stationCodes.find(code);
   
-  if (it == _stationCodes.end()) {
-    return -1;
+  // there are only a handful of stations, a linear scan over the names is fine
+  for (int i = 0; i < _numStations; i++) {
+    int len = _stationNames[i+1] - _stationNames[i];
+    if (len == (int) code.size() && memcmp(_nameChars + _stationNames[i], code.data(), len) == 0) {
+      return i;
+    }
   }
-  return it->second;
+  return -1;
 }
 
-void RMCInput::setTimesForOrder(Order* order, XMLOrder& xmlorder)
+/// Fill the travel times of one yard to and from all stations, returns the maximum travel time
+static int setTimesForYard(int *travelTo, int *travelFrom, int numStations,
+                           const XMLConstructionYard &xmlyard, const std::vector<int> &stationIdx)
 {
-  std::list<_StationDuration_>::iterator ite;
-  for (ite = xmlorder._constructionYard->_stationDuration.begin();
-       ite != xmlorder._constructionYard->_stationDuration.end();
+  int maxTravelTime = 0;
+  
+  for (int i = 0; i < numStations; i++) {
+    travelTo[i]   = MAX_TRAVEL_TIME;
+    travelFrom[i] = MAX_TRAVEL_TIME;
+  }
+  
+  std::list<_StationDuration_>::const_iterator ite;
+  for (ite = xmlyard._stationDuration.begin();
+       ite != xmlyard._stationDuration.end();
        ite++) 
   {
-    int idx = getStation(ite->_stationCode);
+    int idx = stationIdx[ite->_station];
     if (idx != -1) {
       if (ite->_direction == true) {
-        //order->setToYard(idx, (ite->_drivingMinutes==0? 32000 : ite->_drivingMinutes));
-        order->setToYard(idx, ite->_drivingMinutes);
-        
-        _maxTravelTime = std::max(_maxTravelTime, ite->_drivingMinutes);
+        travelTo[idx] = ite->_drivingMinutes;
       } else {
-        //order->setFromYard(idx, (ite->_drivingMinutes==0? 32000 : ite->_drivingMinutes));
-        order->setFromYard(idx, ite->_drivingMinutes);
-        
-        _maxTravelTime = std::max(_maxTravelTime, ite->_drivingMinutes);
+        travelFrom[idx] = ite->_drivingMinutes;
       }
+      maxTravelTime = std::max(maxTravelTime, ite->_drivingMinutes);
     }
   }
+  
+  return maxTravelTime;
 }
 
-int RMCInput::getMinDeliveries(int order) const
+/// Append a name to the character table of an arena that is being filled
+static void addName(InstanceHeader *header, InstanceColumn names, int idx, const std::string &name, size_t &pos)
 {
-  int minCapacity = 0;
+  char *chars = (char*) header + header->offset[IC_NAME_CHARS];
+  memcpy(chars + pos, name.data(), name.size());
+  arenaColumn(header, names)[idx] = pos;
+  pos += name.size();
+  arenaColumn(header, names)[idx+1] = pos;
+}
+
+void RMCInput::getCompatibleCapacities(int order, int &minCapacity, int &maxCapacity) const
+{
+  minCapacity = 0;
+  maxCapacity = 0;
   
   const Order &o = getOrder(order);
   
-  for (int i = 0; i < _vehicles.size(); i++) {
+  for (int i = 0; i < _numVehicles; i++) {
+    if (!canServe(i, order)) continue;
+    
     const Vehicle &v = getVehicle(i);
-    if (v.maxDischargeRate() < o.dischargeRate() || v.pumpLength() < o.requiredPumpLength() || v.volume(o.maxVolumeAllowed()) == 0) 
-      continue;
-      
+    
     if (minCapacity == 0) {
       minCapacity = v.volume(o.maxVolumeAllowed());
     } else {
       minCapacity = std::min(minCapacity, v.volume(o.maxVolumeAllowed()));
     }
+    maxCapacity = std::max(maxCapacity, v.volume(o.maxVolumeAllowed()));
   }
+}
+
+void RMCInput::computeHorizon(int *deadlines, const int *deadlineLimits)
+{
+  _additiveTimeStamp = _maxTimeStamp;
+  _heuristicCost = -1;
   
-  if (minCapacity == 0) {
-    return -1;
+  for (int i = 0; i < _numOrders; i++) {
+    deadlines[i] = deadlineLimits ? std::min(_additiveTimeStamp, deadlineLimits[i]) : _additiveTimeStamp;
   }
   
-  return ((o.totalVolume() - 1) / minCapacity) + 1;
-}
-
-void RMCInput::loadProblem(const char* filename) {
-  std::vector<XMLOrder*> orderList;
-  std::vector<XMLVehicle*> vehicleList;
-  std::vector<XMLStation*> stationList;
-
-  ReadXML xmlReader(filename);
-  xmlReader.parseFile();
-
-  xmlReader.getOrdersList(orderList);
-  xmlReader.getVehiclesList(vehicleList);
-  xmlReader.getStationsList(stationList);
-
-  //xmlReader->print();
+  ListScheduler scheduler(*this);
+  Schedule schedule;
+  if (!scheduler.run(schedule)) {
+    return;
+  }
   
-  //compute the base time stamp
-  _baseTimeStamp = orderList[0]->_unixTimeStamp;
-
-  for (int i=1 ; i < orderList.size(); i++) {
-    if (_baseTimeStamp > orderList[i]->_unixTimeStamp) {
-      _baseTimeStamp = orderList[i]->_unixTimeStamp;
-    }
+  // last unloading of every order in the list schedule
+  std::vector<int> lastUnload(_numOrders, 0);
+  for (size_t i = 0; i < schedule.getDeliveries().size(); i++) {
+    const ScheduledDelivery &d = schedule.getDeliveries()[i];
+    lastUnload[d.order] = std::max(lastUnload[d.order], d.tUnload);
   }
-
-  for (int i=0 ; i < vehicleList.size(); i++) {
-    if (_baseTimeStamp > vehicleList[i]->_nextAvailabelTimeStampUnix) {
-      _baseTimeStamp = vehicleList[i]->_nextAvailabelTimeStampUnix;
-    }
+  
+  // The list schedule does not help if it violates the given deadlines
+  for (int i = 0; deadlineLimits && i < _numOrders; i++) {
+    if (lastUnload[i] > deadlineLimits[i]) return;
   }
-
-  _stations.clear();
-  _vehicles.clear();
-  _orders.clear();
   
-  _maxTravelTime = 0;
-  _maxDeliveries = 0;
-  _maxTimeStamp = 0;
+  _heuristicCost = schedule.getCost();
   
-  int maxLoadTime = 0;
+  // Lateness and time lags are part of the cost. In every schedule that is at most as
+  // expensive as the list schedule, an order can be late (and have time lags) only by what
+  // is left of that cost after the lateness and travel times that all other orders have
+  // anyway. Its last unloading starts before that, plus the unloading of all other deliveries.
+  std::vector<long long> minLateness(_numOrders, 0);
+  long long lowerBound = 0;
   
-  // load stations
-  for(int i = 0 ; i < stationList.size(); i++) {
-    XMLStation &station = *stationList[i];
-    
-    if (station._stationCode.empty()) continue;
+  for (int i = 0; i < _numOrders; i++) {
+    minLateness[i] = getMinLateness(i);
+    lowerBound += minLateness[i] * getAlpha1() + (long long) getMinDeliveries(i) * getMinTravelTimeTo(i) * getAlpha5();
+  }
+  
+  _maxTimeStamp = 0;
+  
+  for (int i = 0; i < _numOrders; i++) {
+    const Order &o = getOrder(i);
     
-    _stationCodes.insert( std::pair<std::string,int>(station._stationCode, _stations.size()) );
+    int minCapacity, maxCapacity;
+    getCompatibleCapacities(i, minCapacity, maxCapacity);
     
-    _stations.push_back( new Station(station._stationCode, station._loadingMinutes) );
+    long long slack = (_heuristicCost - lowerBound + minLateness[i] * getAlpha1()) / std::min(getAlpha1(), getAlpha4());
+    long long unloading = (long long) (getMaxDeliveries(i) - 1) * (maxCapacity / o.dischargeRate());
+    long long horizon = o.timeStart() + slack + unloading;
     
-    maxLoadTime = std::max(maxLoadTime, station._loadingMinutes);
+    // never cut off the list schedule itself
+    deadlines[i] = std::max((long long) lastUnload[i], std::min((long long) deadlines[i], horizon));
+    _maxTimeStamp = std::max(_maxTimeStamp, deadlines[i]);
   }
+}
+
+int RMCInput::computeVehicleMaxDeliveries(int vehicle) const
+{
+  // Shortest duration of every part of a delivery cycle, over all orders the vehicle can serve.
+  // Unloading of delivery d+1 starts at least unload + travelFrom + load + travelTo + setup
+  // after unloading of delivery d started.
+  int minLoad = MAX_TRAVEL_TIME;
+  int minTravelTo = MAX_TRAVEL_TIME;
+  int minTravelFrom = MAX_TRAVEL_TIME;
+  int minSetup = MAX_TRAVEL_TIME;
+  int minUnload = MAX_TRAVEL_TIME;
+  int minStart = _maxTimeStamp;
+  bool served = false;
   
-  //treat each of the cars
-  for (int i = 0; i < vehicleList.size(); i++) {
-    XMLVehicle &currentVehicle = *vehicleList[i];
+  for (int s = 0; s < _numStations; s++) {
+    minLoad = std::min(minLoad, _stationLoadTimes[s]);
+  }
+  
+  for (int o = 0; o < _numOrders; o++) {
+    if (!canServe(vehicle, o)) continue;
+    served = true;
     
-    int timeStamp = (int)difftime(currentVehicle._nextAvailabelTimeStampUnix, _baseTimeStamp);
+    const Order &order = getOrder(o);
     
-    if (currentVehicle._normalVolume == 0 && currentVehicle._maximumVolume == 0) continue;
+    minSetup = std::min(minSetup, order.dTimeSetup());
+    minStart = std::min(minStart, order.timeStart());
+    if (order.dischargeRate() > 0) {
+      minUnload = std::min(minUnload, getUnloadingTime(o, vehicle));
+    } else {
+      minUnload = 0;
+    }
     
-    Vehicle *v = new Vehicle(currentVehicle._vehicleCode, currentVehicle._pumpLength, currentVehicle._dischargeRate * (1000.0/60.0),
-                             currentVehicle._normalVolume * 1000, currentVehicle._maximumVolume * 1000, timeStamp);
-    _vehicles.push_back(v);
+    for (int s = 0; s < _numStations; s++) {
+      minTravelTo   = std::min(minTravelTo, getTravelTimeTo(o, s));
+      minTravelFrom = std::min(minTravelFrom, getTravelTimeFrom(o, s));
+    }
   }
   
-  //treat each of the orders
-  for(int i = 0; i < orderList.size(); i++) {
-    XMLOrder &currentOrder = *orderList[i];
-    
-    int minTimeStamp = (int)difftime(currentOrder._unixTimeStamp, _baseTimeStamp);
-    
-    Order *o = new Order(currentOrder._orderCode, currentOrder._volume * 1000,(currentOrder._dischargeRate * (1000.0/60.0)), 
-                         currentOrder._pumpLength, getStation(currentOrder._preferredStationCode), 
-                         currentOrder._maxVolumeAllowed, minTimeStamp, 
-                         currentOrder._constructionYard->_waitingMinutes, stationList.size());
+  if (!served || _numStations == 0) {
+    return 0;
+  }
+  
+  int firstUnload = std::max(getVehicle(vehicle).availableFrom() + minLoad + minTravelTo + minSetup, minStart);
+  int cycle = std::max(1, minUnload + minTravelFrom + minLoad + minTravelTo + minSetup);
+  
+  if (firstUnload > _maxTimeStamp) {
+    return 0;
+  }
+  
+  return 1 + (_maxTimeStamp - firstUnload) / cycle;
+}
+
+int RMCInput::getMinLeadTime(int order) const
+{
+  int lead = MAX_TRAVEL_TIME;
+  for (int s = 0; s < _numStations; s++) {
+    lead = std::min(lead, _stationLoadTimes[s] + getTravelTimeTo(order, s));
+  }
+  return lead + getOrder(order).dTimeSetup();
+}
+
+int RMCInput::getMinTravelTimeTo(int order) const
+{
+  int travel = MAX_TRAVEL_TIME;
+  for (int s = 0; s < _numStations; s++) {
+    travel = std::min(travel, getTravelTimeTo(order, s));
+  }
+  return travel;
+}
+
+int RMCInput::getMinLateness(int order) const
+{
+  int firstAvailable = INT_MAX;
+  for (int v = 0; v < _numVehicles; v++) {
+    if (canServe(v, order)) firstAvailable = std::min(firstAvailable, getVehicle(v).availableFrom());
+  }
+  if (firstAvailable == INT_MAX) {
+    return 0;
+  }
+  return std::max(0, firstAvailable + getMinLeadTime(order) - getOrder(order).timeStart());
+}
+
+long long RMCInput::getMaxPoured(int order) const
+{
+  int minCapacity, maxCapacity;
+  getCompatibleCapacities(order, minCapacity, maxCapacity);
+  return (long long) getMaxDeliveries(order) * maxCapacity;
+}
+
+int RMCInput::getMaxTravelTime() const
+{
+  int travel = 0;
+  for (int i = 0; i < _numOrders; i++) {
+    for (int s = 0; s < _numStations; s++) {
+      travel = std::max(travel, std::max(getTravelTimeTo(i, s), getTravelTimeFrom(i, s)));
+    }
+  }
+  return travel;
+}
 
-    setTimesForOrder(o, currentOrder);
+int RMCInput::getMaxUnloadingTime() const
+{
+  int unloading = 0;
+  for (int i = 0; i < _numOrders; i++) {
+    for (int v = 0; v < _numVehicles; v++) {
+      if (!canServe(v, i)) continue;
+      unloading = std::max(unloading, getUnloadingTime(i, v));
+    }
+  }
+  return unloading;
+}
 
-    _orders.push_back(o);
+int RMCInput::getMaxPour(int order, int capacity) const
+{
+  // concrete must be poured within getTimeMax() after loading started
+  int lifeTime = getTimeMax() - getMinLeadTime(order);
+  if (lifeTime <= 0) {
+    return 0;
   }
+  return std::min(capacity, lifeTime * getOrder(order).dischargeRate());
+}
 
-  if (_vehicles.empty()) return;
+void RMCInput::computeBounds(InstanceHeader *header, const int *deadlineLimits)
+{
+  int numO = _numOrders;
+  int numV = _numVehicles;
   
-  // TODO make this more tight! (i.e., use a greedy alg. to assign yards to trucks
+  int maxLoadTime = 0;
+  for (int i = 0; i < _numStations; i++) {
+    maxLoadTime = std::max(maxLoadTime, _stationLoadTimes[i]);
+  }
   
-  // find the smallest vehicle capacity
-  int minCapacity = _vehicles[0]->volume(false);
-  for (int i = 1; i < _vehicles.size(); i++) {
-    minCapacity = std::min(minCapacity, _vehicles[i]->volume(false));
+  // [order, vehicle] volumes, and whether the vehicle has the pump length, discharge rate and
+  // volume required by the order
+  int *orderVehicleVolumes    = arenaColumn(header, IC_ORDER_VEHICLE_VOLUMES);
+  int *orderVehicleCompatible = arenaColumn(header, IC_ORDER_VEHICLE_COMPATIBLE);
+  for (int j = 0; j < numO; j++) {
+    const Order &o = getOrder(j);
+    for (int i = 0; i < numV; i++) {
+      const Vehicle &v = getVehicle(i);
+      orderVehicleVolumes[ j * numV + i ] = v.volume(o.maxVolumeAllowed());
+      orderVehicleCompatible[ j * numV + i ] = v.maxDischargeRate() >= o.dischargeRate() && 
+                                               v.pumpLength() >= o.requiredPumpLength() && 
+                                               v.volume(o.maxVolumeAllowed()) > 0;
+    }
+  }
+
+  // Vehicles with the same pump, discharge rate, volumes and availability are interchangeable
+  static const InstanceColumn vehicleAttributes[] = {
+    IC_VEHICLE_PUMP_LENGTHS, IC_VEHICLE_DISCHARGE_RATES, IC_VEHICLE_NORMAL_VOLUMES, 
+    IC_VEHICLE_MAX_VOLUMES, IC_VEHICLE_AVAILABLE
+  };
+  int *vehicleClasses = arenaColumn(header, IC_VEHICLE_CLASSES);
+  for (int i = 0; i < numV; i++) {
+    vehicleClasses[i] = i;
+    for (int j = 0; j < i && vehicleClasses[i] == i; j++) {
+      if (vehicleClasses[j] != j) continue;
+      
+      bool equal = true;
+      for (size_t a = 0; equal && a < sizeof(vehicleAttributes) / sizeof(vehicleAttributes[0]); a++) {
+        equal = arenaColumn(header, vehicleAttributes[a])[i] == arenaColumn(header, vehicleAttributes[a])[j];
+      }
+      if (equal) {
+        vehicleClasses[i] = j;
+      }
+    }
   }
   
-  // count how many deliveries are needed at most per order
-  for (int i = 0; i < _orders.size(); i++) {
-    Order &order = *_orders[i];
+  // count how many deliveries are needed at most per order, using the smallest vehicle that can
+  // serve the order and the closest station. Orders that can not be served get one slot and
+  // -1 as lower bound, main rejects them.
+  // Even with only the largest vehicles and the closest station we need the lower bound.
+  int *orderMaxDeliveries   = arenaColumn(header, IC_ORDER_MAX_DELIVERIES);
+  int *orderMinDeliveries   = arenaColumn(header, IC_ORDER_MIN_DELIVERIES);
+  int *orderDeliveryOffsets = arenaColumn(header, IC_ORDER_DELIVERY_OFFSETS);
+  
+  orderDeliveryOffsets[0] = 0;
+  
+  for (int i = 0; i < numO; i++) {
+    const Order &order = getOrder(i);
     
-    int volume = order.totalVolume();
-    int deliveries = volume / minCapacity;
+    int minCapacity, maxCapacity;
+    getCompatibleCapacities(i, minCapacity, maxCapacity);
     
-    int timeDelivery = maxLoadTime + 2 * _maxTravelTime + order.dTimeSetup() 
-                     + minCapacity / order.dischargeRate();
+    int deliveries = 1;
+    int timeDelivery = maxLoadTime + 2 * _maxTravelTime + order.dTimeSetup();
     
-    _maxDeliveries = std::max(_maxDeliveries, deliveries);
+    int minPour = getMaxPour(i, minCapacity);
+    if (minPour > 0) {
+      deliveries = ((order.totalVolume() - 1) / minPour) + 1;
+      timeDelivery += minCapacity / order.dischargeRate();
+    }
+    
+    int maxPour = getMaxPour(i, maxCapacity);
+    orderMinDeliveries[i] = (maxPour > 0) ? ((order.totalVolume() - 1) / maxPour) + 1 : -1;
+    
+    orderMaxDeliveries[i] = deliveries;
+    orderDeliveryOffsets[i+1] = orderDeliveryOffsets[i] + deliveries;
     
     _maxTimeStamp = std::max(_maxTimeStamp, order.timeStart());
     _maxTimeStamp += deliveries * timeDelivery;
   }
   
-  buildValueArrays();
+  _maxDeliveries = orderDeliveryOffsets[numO];
+  
+  computeHorizon(arenaColumn(header, IC_ORDER_DEADLINES), deadlineLimits);
+  
+  // a vehicle can not do more deliveries than fit into the horizon, nor more than all orders need
+  int *vehicleMaxDeliveries   = arenaColumn(header, IC_VEHICLE_MAX_DELIVERIES);
+  int *vehicleDeliveryOffsets = arenaColumn(header, IC_VEHICLE_DELIVERY_OFFSETS);
+  
+  for (int i = 0; i < numV; i++) {
+    vehicleMaxDeliveries[i] = std::min(computeVehicleMaxDeliveries(i), _maxDeliveries);
+  }
+  
+  // Equivalent vehicles need the same number of slots to be interchangeable in the model
+  for (int i = 0; i < numV; i++) {
+    int &first = vehicleMaxDeliveries[vehicleClasses[i]];
+    first = std::max(first, vehicleMaxDeliveries[i]);
+  }
+  for (int i = 0; i < numV; i++) {
+    vehicleMaxDeliveries[i] = vehicleMaxDeliveries[vehicleClasses[i]];
+  }
+
+  vehicleDeliveryOffsets[0] = 0;
+  for (int i = 0; i < numV; i++) {
+    vehicleDeliveryOffsets[i+1] = vehicleDeliveryOffsets[i] + vehicleMaxDeliveries[i];
+  }
+  
+  header->maxDeliveries = _maxDeliveries;
+  header->maxTimeStamp  = _maxTimeStamp;
+  header->additiveTimeStamp = _additiveTimeStamp;
+  header->heuristicCost = _heuristicCost;
+  
 }
 
-void RMCInput::buildValueArrays()
+/// How a column changes when the instance is moved to a coarser time grid
+enum ColumnScaling {
+  SCALE_NONE,
+  // durations and earliest times, rounded up
+  SCALE_TIME,
+  // amounts per time unit
+  SCALE_RATE
+};
+
+static int scaleValue(int value, ColumnScaling scaling, int granularity)
 {
-  _orderStartTimes = new int[_orders.size()];
-  _orderReqDischargeRates = new int[_orders.size()];
-  _orderReqPipeLength = new int[_orders.size()];
-  _orderTotalVolumes = new int[_orders.size()];
-  _orderSetupTimes = new int[_orders.size()];
-  _orderPreferredStations = new int[_orders.size()];
+  switch (scaling) {
+  case SCALE_TIME:
+    if (value >= MAX_TRAVEL_TIME) return value;
+    return value >= 0 ? (value + granularity - 1) / granularity : -(-value / granularity);
+  case SCALE_RATE:
+    return value * granularity;
+  default:
+    return value;
+  }
+}
+
+bool RMCInput::loadSubProblem(const RMCInput &input, const std::vector<int> &orders, const std::vector<int> &vehicles)
+{
+  return extractProblem(input, orders, vehicles, 1);
+}
+
+bool RMCInput::coarsen(const RMCInput &input, int granularity)
+{
+  std::vector<int> orders(input._numOrders);
+  std::vector<int> vehicles(input._numVehicles);
+  for (int i = 0; i < input._numOrders; i++) orders[i] = i;
+  for (int i = 0; i < input._numVehicles; i++) vehicles[i] = i;
   
-  for (int i = 0; i < _orders.size(); i++) {
-    Order *o = _orders[i];
-    _orderStartTimes[i] = o->timeStart();
-    _orderReqDischargeRates[i] = o->dischargeRate();
-    _orderReqPipeLength[i] = o->requiredPumpLength();
-    _orderTotalVolumes[i] = o->totalVolume();
-    _orderSetupTimes[i] = o->dTimeSetup();
-    _orderPreferredStations[i] = o->preferredStation();
+  return extractProblem(input, orders, vehicles, std::max(1, granularity));
+}
+
+bool RMCInput::extractProblem(const RMCInput &input, const std::vector<int> &orders, const std::vector<int> &vehicles,
+                              int granularity)
+{
+  static const InstanceColumn orderColumns[] = {
+    IC_ORDER_START_TIMES, IC_ORDER_TOTAL_VOLUMES, IC_ORDER_DISCHARGE_RATES, IC_ORDER_PIPE_LENGTHS,
+    IC_ORDER_SETUP_TIMES, IC_ORDER_PREF_STATIONS, IC_ORDER_MAX_VOLUME, IC_ORDER_YARDS
+  };
+  static const ColumnScaling orderScaling[] = {
+    SCALE_TIME, SCALE_NONE, SCALE_RATE, SCALE_NONE,
+    SCALE_TIME, SCALE_NONE, SCALE_NONE, SCALE_NONE
+  };
+  static const InstanceColumn vehicleColumns[] = {
+    IC_VEHICLE_PUMP_LENGTHS, IC_VEHICLE_DISCHARGE_RATES, IC_VEHICLE_NORMAL_VOLUMES, 
+    IC_VEHICLE_MAX_VOLUMES, IC_VEHICLE_AVAILABLE
+  };
+  static const ColumnScaling vehicleScaling[] = {
+    SCALE_NONE, SCALE_RATE, SCALE_NONE, SCALE_NONE, SCALE_TIME
+  };
+  
+  int numO = orders.size();
+  int numV = vehicles.size();
+  int numS = input._numStations;
+  int numY = input._numYards;
+  
+  // stations and yards are kept completely, so their indices do not change
+  size_t nameChars = 0;
+  for (int i = 0; i < numO; i++) nameChars += input.getOrderName(orders[i]).size();
+  for (int i = 0; i < numV; i++) nameChars += input.getVehicleName(vehicles[i]).size();
+  for (int i = 0; i < numS; i++) nameChars += input.getStationName(i).size();
+  for (int i = 0; i < numY; i++) nameChars += input.getYardCode(i).size();
+  
+  InstanceHeader *header = allocateArena(numO, numV, numS, numY, nameChars);
+  if (!header) {
+    printf("error: out of memory extracting a sub problem\n");
+    return false;
   }
+  header->baseTimeStamp = input._baseTimeStamp;
+  header->maxTravelTime = scaleValue(input._maxTravelTime, SCALE_TIME, granularity);
+  // concrete must not be poured later than at full resolution, so the lifetime is rounded down
+  header->timeMax       = input._timeMax / granularity;
+  header->timeScale     = input._timeScale * granularity;
   
-  _stationLoadTimes = new int[_stations.size()];
+  const InstanceHeader *from = (const InstanceHeader*) input._arena;
+  size_t namePos = 0;
   
-  for (int i = 0; i < _stations.size(); i++) {
-    Station *s = _stations[i];
-    _stationLoadTimes[i] = s->loadingMinutes(); 
+  for (int i = 0; i < numS; i++) {
+    arenaColumn(header, IC_STATION_LOAD_TIMES)[i] = scaleValue(input._stationLoadTimes[i], SCALE_TIME, granularity);
+    addName(header, IC_STATION_NAMES, i, input.getStationName(i), namePos);
+  }
+  for (int i = 0; i < numY; i++) {
+    addName(header, IC_YARD_NAMES, i, input.getYardCode(i), namePos);
+  }
+  if (granularity == 1) {
+    memcpy(arenaColumn(header, IC_TRAVEL_TO),   input._travelTimesTo,   numY * numS * sizeof(int32_t));
+    memcpy(arenaColumn(header, IC_TRAVEL_FROM), input._travelTimesFrom, numY * numS * sizeof(int32_t));
+  } else {
+    for (int i = 0; i < numY * numS; i++) {
+      arenaColumn(header, IC_TRAVEL_TO)[i]   = scaleValue(input._travelTimesTo[i], SCALE_TIME, granularity);
+      arenaColumn(header, IC_TRAVEL_FROM)[i] = scaleValue(input._travelTimesFrom[i], SCALE_TIME, granularity);
+    }
   }
   
-  _orderVehicleVolumes = new int[_orders.size() * _vehicles.size()];
+  for (int i = 0; i < numV; i++) {
+    for (size_t c = 0; c < sizeof(vehicleColumns) / sizeof(vehicleColumns[0]); c++) {
+      const int *column = (const int*) (input._arena + from->offset[vehicleColumns[c]]);
+      arenaColumn(header, vehicleColumns[c])[i] = scaleValue(column[vehicles[i]], vehicleScaling[c], granularity);
+    }
+    addName(header, IC_VEHICLE_NAMES, i, input.getVehicleName(vehicles[i]), namePos);
+  }
   
-  for (int j = 0; j < _orders.size(); j++) {
-    Order *o = _orders[j];
-    for (int i = 0; i < _vehicles.size(); i++) {
-      Vehicle *v = _vehicles[i];
-      _orderVehicleVolumes[ j * _vehicles.size() + i ] = v->volume(o->maxVolumeAllowed());
+  // orders keep their deadlines, so that sub problems solved separately do not interfere
+  std::vector<int> deadlines(numO);
+  for (int i = 0; i < numO; i++) {
+    for (size_t c = 0; c < sizeof(orderColumns) / sizeof(orderColumns[0]); c++) {
+      const int *column = (const int*) (input._arena + from->offset[orderColumns[c]]);
+      arenaColumn(header, orderColumns[c])[i] = scaleValue(column[orders[i]], orderScaling[c], granularity);
     }
+    addName(header, IC_ORDER_NAMES, i, input.getOrderName(orders[i]), namePos);
+    deadlines[i] = input._orderDeadlines[orders[i]];
+  }
+  
+  releaseArena();
+  attachArena((char*) header, header->arenaSize, false);
+  
+  // the deadlines are horizons of the list schedule at full resolution, a coarser grid needs its own
+  computeBounds(header, (deadlines.empty() || granularity > 1) ? NULL : &deadlines[0]);
+  
+  return true;
+}
+
+bool RMCInput::loadProblem(const char* filename) {
+  if (isCompiled(filename)) {
+    return loadCompiled(filename);
+  }
+  
+  std::vector<XMLOrder*> orderList;
+  std::vector<XMLVehicle*> vehicleList;
+  std::vector<XMLStation*> stationList;
+  std::vector<XMLConstructionYard*> yardList;
+
+  ReadXML xmlReader(filename);
+  if (!xmlReader.parseFile()) {
+    return false;
+  }
+
+  xmlReader.getOrdersList(orderList);
+  xmlReader.getVehiclesList(vehicleList);
+  xmlReader.getStationsList(stationList);
+  xmlReader.getConstructionYardsList(yardList);
+
+  //xmlReader->print();
+  
+  if (orderList.empty()) {
+    printf("error: no orders in file %s\n", filename);
+    return false;
   }
   
-  _travelTimesTo   = new int[_orders.size() * _stations.size()];
-  _travelTimesFrom = new int[_orders.size() * _stations.size()];
+  for (int i = 0; i < orderList.size(); i++) {
+    if (orderList[i]->_constructionYard == -1) {
+      printf("error: no construction yard for order %s\n", orderList[i]->_orderCode.c_str());
+      return false;
+    }
+  }
   
-  for (int i = 0; i < _orders.size(); i++) {
-    Order *o = _orders[i];
-    for (int j = 0; j < _stations.size(); j++) {
-      _travelTimesTo  [ i * _stations.size() + j ] = o->toStation(j);
-      _travelTimesFrom[ i * _stations.size() + j ] = o->fromStation(j);
+  //compute the base time stamp
+  time_t baseTimeStamp = orderList[0]->_unixTimeStamp;
+
+  for (int i=1 ; i < orderList.size(); i++) {
+    if (baseTimeStamp > orderList[i]->_unixTimeStamp) {
+      baseTimeStamp = orderList[i]->_unixTimeStamp;
     }
   }
+
+  for (int i=0 ; i < vehicleList.size(); i++) {
+    if (baseTimeStamp > vehicleList[i]->_nextAvailabelTimeStampUnix) {
+      baseTimeStamp = vehicleList[i]->_nextAvailabelTimeStampUnix;
+    }
+  }
+  
+  // select the stations and vehicles to keep, and size the name table
+  std::vector<XMLStation*> stations;
+  std::vector<XMLVehicle*> vehicles;
+  std::map<std::string, int> stationCodes;
+  size_t nameChars = 0;
+  
+  for (int i = 0; i < stationList.size(); i++) {
+    if (stationList[i]->_stationCode.empty()) continue;
+    stationCodes.insert( std::pair<std::string,int>(stationList[i]->_stationCode, stations.size()) );
+    stations.push_back(stationList[i]);
+    nameChars += stationList[i]->_stationCode.size();
+  }
+  for (int i = 0; i < vehicleList.size(); i++) {
+    if (vehicleList[i]->_normalVolume == 0 && vehicleList[i]->_maximumVolume == 0) continue;
+    vehicles.push_back(vehicleList[i]);
+    nameChars += vehicleList[i]->_vehicleCode.size();
+  }
+  for (int i = 0; i < orderList.size(); i++) {
+    nameChars += orderList[i]->_orderCode.size();
+  }
+  for (int i = 0; i < yardList.size(); i++) {
+    nameChars += yardList[i]->_code.size();
+  }
+  
+  int numO = orderList.size();
+  int numV = vehicles.size();
+  int numS = stations.size();
+  int numY = yardList.size();
+  
+  InstanceHeader *header = allocateArena(numO, numV, numS, numY, nameChars);
+  if (!header) {
+    printf("error: out of memory loading %s\n", filename);
+    return false;
+  }
+  header->baseTimeStamp = baseTimeStamp;
+  header->timeMax       = DEFAULT_TIME_MAX;
+  header->timeScale     = 1;
+  
+  size_t namePos = 0;
+  
+  // load stations
+  int *stationLoadTimes = arenaColumn(header, IC_STATION_LOAD_TIMES);
+  for (int i = 0; i < numS; i++) {
+    stationLoadTimes[i] = stations[i]->_loadingMinutes;
+    addName(header, IC_STATION_NAMES, i, stations[i]->_stationCode, namePos);
+  }
+  
+  // store travel times once per construction yard
+  std::vector<int> stationIdx(xmlReader.getNumStationCodes());
+  for (size_t i = 0; i < stationIdx.size(); i++) {
+    std::map<std::string, int>::const_iterator it = stationCodes.find(xmlReader.getStationCode(i));
+    stationIdx[i] = (it == stationCodes.end()) ? -1 : it->second;
+  }
+  
+  int *travelTo   = arenaColumn(header, IC_TRAVEL_TO);
+  int *travelFrom = arenaColumn(header, IC_TRAVEL_FROM);
+  int maxTravelTime = 0;
+  
+  for (int i = 0; i < numY; i++) {
+    addName(header, IC_YARD_NAMES, i, yardList[i]->_code, namePos);
+    maxTravelTime = std::max(maxTravelTime,
+                             setTimesForYard(travelTo + i * numS, travelFrom + i * numS, numS, *yardList[i], stationIdx));
+  }
+  header->maxTravelTime = maxTravelTime;
+  
+  //treat each of the cars
+  for (int i = 0; i < numV; i++) {
+    XMLVehicle &currentVehicle = *vehicles[i];
+    
+    int timeStamp = (int)difftime(currentVehicle._nextAvailabelTimeStampUnix, baseTimeStamp);
+    
+    arenaColumn(header, IC_VEHICLE_PUMP_LENGTHS)[i]    = currentVehicle._pumpLength;
+    arenaColumn(header, IC_VEHICLE_DISCHARGE_RATES)[i] = currentVehicle._dischargeRate * (1000.0/60.0);
+    arenaColumn(header, IC_VEHICLE_NORMAL_VOLUMES)[i]  = currentVehicle._normalVolume * 1000;
+    arenaColumn(header, IC_VEHICLE_MAX_VOLUMES)[i]     = currentVehicle._maximumVolume * 1000;
+    arenaColumn(header, IC_VEHICLE_AVAILABLE)[i]       = timeStamp;
+    addName(header, IC_VEHICLE_NAMES, i, currentVehicle._vehicleCode, namePos);
+  }
+  
+  //treat each of the orders
+  for (int i = 0; i < numO; i++) {
+    XMLOrder &currentOrder = *orderList[i];
+    
+    int minTimeStamp = (int)difftime(currentOrder._unixTimeStamp, baseTimeStamp);
+    
+    const XMLConstructionYard &yard = *yardList[currentOrder._constructionYard];
+    
+    std::map<std::string, int>::const_iterator pref = stationCodes.find(currentOrder._preferredStationCode);
+    
+    arenaColumn(header, IC_ORDER_START_TIMES)[i]     = minTimeStamp;
+    arenaColumn(header, IC_ORDER_TOTAL_VOLUMES)[i]   = currentOrder._volume * 1000;
+    arenaColumn(header, IC_ORDER_DISCHARGE_RATES)[i] = currentOrder._dischargeRate * (1000.0/60.0);
+    arenaColumn(header, IC_ORDER_PIPE_LENGTHS)[i]    = currentOrder._pumpLength;
+    arenaColumn(header, IC_ORDER_SETUP_TIMES)[i]     = yard._waitingMinutes;
+    arenaColumn(header, IC_ORDER_PREF_STATIONS)[i]   = (pref == stationCodes.end()) ? -1 : pref->second;
+    arenaColumn(header, IC_ORDER_MAX_VOLUME)[i]      = currentOrder._maxVolumeAllowed ? 1 : 0;
+    arenaColumn(header, IC_ORDER_YARDS)[i]           = currentOrder._constructionYard;
+    addName(header, IC_ORDER_NAMES, i, currentOrder._orderCode, namePos);
+  }
+  
+  releaseArena();
+  attachArena((char*) header, header->arenaSize, false);
   
+  computeBounds(header, NULL);
   
+  return true;
 }
 
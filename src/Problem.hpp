@@ -12,141 +12,82 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <ctime>
 
 
 static const int MAX_TRAVEL_TIME = 5000000;
 
+/// Time between loading and the end of unloading of a delivery at full resolution
+static const int DEFAULT_TIME_MAX = 100;
+
+class RMCInput;
+
+/// Lightweight view of one order, the data is stored in the columns of RMCInput
 class Order {
 public:
-  /// volumes in dm3, rates in dm3/min
-  Order(const std::string &name, int vol, int dischargeRate, int pumpLength, int preferredStation,
-        bool maxVolumeAllowed, int startTime, int setupTime, int numStations)
-  : _name(name),
-    _totalVolume(vol), _dischargeRate(dischargeRate), 
-    _requiredPumpLength(pumpLength), _preferredStation(preferredStation),
-    _startTime(startTime), _setupTime(setupTime), _maxVolumeAllowed(maxVolumeAllowed)
-  {  
-    for(int i = 0; i < numStations; i++){
-      _dTimeFromStations.push_back(MAX_TRAVEL_TIME);
-      _dTimeToStations.push_back(MAX_TRAVEL_TIME);
-    }
-  }
-  
-  virtual ~Order(){}
+  Order(const RMCInput &input, int idx) : _input(&input), _idx(idx) {}
 
-  std::string name() const { return _name; }
+  std::string name() const;
   
-  int requiredPumpLength() const {return _requiredPumpLength;}
+  int requiredPumpLength() const;
 
   // dm3
-  int totalVolume() const {return _totalVolume;}
+  int totalVolume() const;
 
-  int preferredStation() const {return _preferredStation;}
+  int preferredStation() const;
 
-  int timeStart() const {return _startTime;}
+  int timeStart() const;
 
-  int dTimeSetup() const {return _setupTime;}
+  int dTimeSetup() const;
 
   // dm3 / min
-  int dischargeRate() const {return _dischargeRate;}
+  int dischargeRate() const;
   
-  bool maxVolumeAllowed() const { return _maxVolumeAllowed; }
+  bool maxVolumeAllowed() const;
   
-  //returns the time necessary to travel from station to current order
-  int fromStation(int station) const {
-    return _dTimeFromStations[station];
-  }
-  //returns the time necessary to travel from current order to station
-  int toStation(int station) const {
-    return _dTimeToStations[station];
-  }
-
-  void setFromYard(int i, int val) {
-    _dTimeFromStations[i]=val;
-  }
-
-  void setToYard(int i, int val) {
-    _dTimeToStations[i]=val;
-  }
+  /// index of the construction yard, travel times are stored per yard
+  int yard() const;
 
 private:
-  std::string _name;
-  
-  int _totalVolume;
-  int _dischargeRate;
-  int _requiredPumpLength;
-  int _preferredStation;
-  int _startTime;
-  int _setupTime;
-  bool _maxVolumeAllowed;
-
-  std::vector<int> _dTimeToStations;
-  std::vector<int> _dTimeFromStations;
+  const RMCInput *_input;
+  int _idx;
 };
 
 
+/// Lightweight view of one vehicle, the data is stored in the columns of RMCInput
 class Vehicle {
 public:
-  /// volumes in dm3, rates in dm3/min
-  Vehicle(const std::string &name, int pumpLength, int maxDischargeRate, int normalVolume, 
-          int maxVolume, int availFrom)
-  : _name(name),
-    _pumpLenght(pumpLength), _maxDischargeRate(maxDischargeRate), 
-    _normalVolume(normalVolume), _maxVolume(maxVolume), _availableFrom(availFrom)
-  {}
-  
-  virtual ~Vehicle() {}
+  Vehicle(const RMCInput &input, int idx) : _input(&input), _idx(idx) {}
   
-  std::string name() const { return _name; }
+  std::string name() const;
   
-  int pumpLength() const {
-    return _pumpLenght;
-  }
+  int pumpLength() const;
   
   /// dm3 / min
-  int maxDischargeRate() const {
-    return _maxDischargeRate;
-  }
+  int maxDischargeRate() const;
   
   // dm3
-  int volume(bool maxVolume) const {
-    if (_maxVolume == _normalVolume) {
-      return _maxVolume;
-    }
-    if (maxVolume && _maxVolume) {
-      return _maxVolume;
-    }
-    return _normalVolume;
-  }
+  int volume(bool maxVolume) const;
   
-  int availableFrom() const {
-    return _availableFrom;
-  }
+  int availableFrom() const;
 
 private:
-  std::string _name;
-  
-  int _pumpLenght;
-  int _maxDischargeRate;
-  int _normalVolume;
-  int _maxVolume;
-  int _availableFrom;
+  const RMCInput *_input;
+  int _idx;
 };
 
+/// Lightweight view of one station, the data is stored in the columns of RMCInput
 class Station {
 public:
-  Station(const std::string &name, int loadingMinutes) 
-  : _name(name), _loadingMinutes(loadingMinutes) 
-  {}
+  Station(const RMCInput &input, int idx) : _input(&input), _idx(idx) {}
   
-  std::string name() const { return _name; }
+  std::string name() const;
   
-  int loadingMinutes() const { return _loadingMinutes; }
+  int loadingMinutes() const;
   
 private:
-  std::string _name;
-  int _loadingMinutes;
+  const RMCInput *_input;
+  int _idx;
 };
 
 class Delivery {
@@ -157,13 +98,38 @@ public:
   virtual ~Delivery() {}
 };
 
+struct InstanceHeader;
+
+/// Problem instance, stored as struct of arrays in a single arena (see InstanceLayout.hpp)
+/// that is either allocated while loading XML or a memory mapped compiled instance.
 class RMCInput { 
 public:
-  RMCInput() {}
+  RMCInput();
+  
+  virtual ~RMCInput();
+  
+  /// Load either a planning XML file or a compiled instance written by saveCompiled,
+  /// returns false if the file could not be loaded
+  bool loadProblem(const char *filename);
+  
+  /// Load the part of another instance with the given orders and vehicles. All stations and yards
+  /// are kept, deadlines of orders are not relaxed. Returns false if out of memory.
+  bool loadSubProblem(const RMCInput &input, const std::vector<int> &orders, const std::vector<int> &vehicles);
+  
+  /// Load another instance on a time grid that is granularity times coarser. Durations and
+  /// earliest times are rounded up and the lifetime of concrete down, so the times of a coarse
+  /// schedule scaled back by getTimeScale() keep all constraints. Discharge rates are scaled up
+  /// for the poured volume, unloading times come from getUnloadingTime(), which rounds them up.
+  /// Returns false if out of memory.
+  bool coarsen(const RMCInput &input, int granularity);
+  
+  /// Write the loaded instance to a compiled instance file, returns false on errors
+  bool saveCompiled(const char *filename) const;
   
-  void loadProblem(const char *filename);
+  int getTimeMax() const { return _timeMax; }
   
-  int getTimeMax() const { return 100; }
+  /// Length of one time unit of this instance in time units of the planning file, 1 unless coarsened
+  int getTimeScale() const { return _timeScale; }
   
   int getAlpha1() const { return 10; }
   
@@ -176,36 +142,85 @@ public:
   int getAlpha5() const { return 20; }
   
   
-  int getNumVehicles() const { return _vehicles.size(); }
+  int getNumVehicles() const { return _numVehicles; }
   
-  int getNumStations() const { return _stations.size(); }
+  int getNumStations() const { return _numStations; }
   
-  int getNumOrders() const { return _orders.size(); }
+  int getNumOrders() const { return _numOrders; }
+  
+  int getNumYards() const { return _numYards; }
+  
+  std::string getYardCode(int yard) const { return getName(_yardNames, yard); }
 
-  // Per order
-  int getMaxDeliveries() const { return _maxDeliveries; }
+  // Per order, computed from the vehicles that can serve the order
+  int getMaxDeliveries(int order) const { return _orderMaxDeliveries[order]; }
+  
+  /// Lower bound on the deliveries of an order, -1 if no vehicle can serve it
+  int getMinDeliveries(int order) const { return _orderMinDeliveries[order]; }
+  
+  /// Shortest time from the start of loading to the start of unloading for an order
+  int getMinLeadTime(int order) const;
+  
+  /// Shortest travel time from any station to the yard of an order
+  int getMinTravelTimeTo(int order) const;
+  
+  /// Lateness of an order if its first delivery is done by the earliest available vehicle
+  int getMinLateness(int order) const;
+  
+  /// Upper bound on the concrete poured for an order, by its maximum deliveries
+  long long getMaxPoured(int order) const;
+  
+  /// Longest travel time in either direction over all orders and stations
+  int getMaxTravelTime() const;
+  
+  /// Longest unloading time of any vehicle that can serve an order
+  int getMaxUnloadingTime() const;
+  
+  /// Time to unload the vehicle for the order. On a coarse grid this is the unloading time on the
+  /// grid of the planning file rounded up, so that it is not shorter once scaled back.
+  int getUnloadingTime(int order, int vehicle) const {
+    long long volume = _orderVehicleVolumes[order * _numVehicles + vehicle];
+    long long fine = volume * _timeScale / _orderReqDischargeRates[order];
+    return (int) ((fine + _timeScale - 1) / _timeScale);
+  }
   
-  int getMinDeliveries(int order) const;
+  /// Deliveries of all orders together
+  int getMaxDeliveries() const { return _maxDeliveries; }
   
+  // Per vehicle, limited by the horizon and the shortest delivery cycle of the vehicle
+  int getMaxVehicleDeliveries(int vehicle) const { return _vehicleMaxDeliveries[vehicle]; }
   
-  // overall deliveries
-  int getMaxTotalDeliveries() const { return _orders.size() * _vehicles.size() * _maxDeliveries; }
+  // overall delivery slots of all vehicles
+  int getMaxTotalDeliveries() const { return _vehicleDeliveryOffsets ? _vehicleDeliveryOffsets[_numVehicles] : 0; }
   
+  /// Scheduling horizon, derived from the list schedule (see getHeuristicCost)
   int getMaxTimeStamp() const { return _maxTimeStamp; }
   
+  /// Horizon from adding up worst case delivery times of all orders, for comparison
+  int getAdditiveTimeStamp() const { return _additiveTimeStamp; }
+  
+  /// Cost of the list schedule computed while loading, -1 if it did not find a schedule
+  int getHeuristicCost() const { return _heuristicCost; }
+  
+  /// Time stamp that all times of this instance are relative to
+  time_t getBaseTimeStamp() const { return _baseTimeStamp; }
+  
   int getStation(const std::string &code) const;
   
-  const std::vector<Order*>& getOrders() const { return _orders; }
+  /// True if the vehicle has the pump length, discharge rate and volume required by the order
+  bool canServe(int vehicle, int order) const { return _orderVehicleCompatible[order * _numVehicles + vehicle] != 0; }
+  
+  Order getOrder(int idx) const { return Order(*this, idx); }
   
-  const std::vector<Vehicle*>& getVehicles() const { return _vehicles; }
+  Vehicle getVehicle(int idx) const { return Vehicle(*this, idx); }
   
-  const std::vector<Station*>& getStations() const { return _stations; }
+  Station getStation(int idx) const { return Station(*this, idx); }
   
-  const Order &getOrder(int idx) const { return *_orders[idx]; }
+  std::string getOrderName(int idx) const { return getName(_orderNames, idx); }
   
-  const Vehicle &getVehicle(int idx) const { return *_vehicles[idx]; }
+  std::string getVehicleName(int idx) const { return getName(_vehicleNames, idx); }
   
-  const Station &getStation(int idx) const { return *_stations[idx]; }
+  std::string getStationName(int idx) const { return getName(_stationNames, idx); }
   
 
   const int* getOrderStartTimes() const { return _orderStartTimes; }  
@@ -215,6 +230,9 @@ public:
   // [order, vehicle]
   const int* getOrderVehicleVolumes() const { return _orderVehicleVolumes; }
   
+  // [order, vehicle], 1 if the vehicle can serve the order
+  const int* getOrderVehicleCompatible() const { return _orderVehicleCompatible; }
+  
   const int* getOrderReqDischargeRates() const { return _orderReqDischargeRates; }
   
   const int* getOrderReqPipeLengths() const { return _orderReqPipeLength; }
@@ -223,50 +241,211 @@ public:
   
   const int* getOrderPreferredStations() const { return _orderPreferredStations; }
   
-  // [order, station]
+  // 1 if the order allows the maximum volume of vehicles
+  const int* getOrderMaxVolumeAllowed() const { return _orderMaxVolumeAllowed; }
+  
+  // yard per order
+  const int* getOrderYards() const { return _orderYards; }
+  
+  const int* getOrderMaxDeliveries() const { return _orderMaxDeliveries; }
+  
+  const int* getOrderMinDeliveries() const { return _orderMinDeliveries; }
+  
+  // Latest start of unloading per order. Schedules that are at most as expensive as the list
+  // schedule meet these deadlines.
+  const int* getOrderDeadlines() const { return _orderDeadlines; }
+  
+  // first slot of every order in arrays holding getMaxDeliveries(order) entries per order,
+  // numOrders + 1 entries
+  const int* getOrderDeliveryOffsets() const { return _orderDeliveryOffsets; }
+  
+  const int* getVehiclePumpLengths() const { return _vehiclePumpLengths; }
+  
+  const int* getVehicleDischargeRates() const { return _vehicleDischargeRates; }
+  
+  const int* getVehicleNormalVolumes() const { return _vehicleNormalVolumes; }
+  
+  const int* getVehicleMaxVolumes() const { return _vehicleMaxVolumes; }
+  
+  const int* getVehicleAvailableFrom() const { return _vehicleAvailableFrom; }
+  
+  const int* getVehicleMaxDeliveries() const { return _vehicleMaxDeliveries; }
+  
+  // first vehicle of the equivalence class of every vehicle. Vehicles of a class have the same
+  // attributes and delivery slots, they only differ in their names.
+  const int* getVehicleClasses() const { return _vehicleClasses; }
+  
+  // first slot of every vehicle in arrays holding getMaxVehicleDeliveries(vehicle) entries
+  // per vehicle, numVehicles + 1 entries
+  const int* getVehicleDeliveryOffsets() const { return _vehicleDeliveryOffsets; }
+  
+  // [yard, station]
   const int* getTravelTimesToYards() const { return _travelTimesTo; }
   
-  // [order, station]
+  // [yard, station]
   const int* getTravelTimesFromYards() const { return _travelTimesFrom; }
   
+  int getTravelTimeTo(int order, int station) const { 
+    return _travelTimesTo[_orderYards[order] * _numStations + station]; 
+  }
+  
+  int getTravelTimeFrom(int order, int station) const { 
+    return _travelTimesFrom[_orderYards[order] * _numStations + station]; 
+  }
+  
   const int* getStationLoadTimes() const { return _stationLoadTimes; }
   
   
 private:
-  void setTimesForOrder(Order *order, XMLOrder &xmlorder);
+  RMCInput(const RMCInput&);
+  RMCInput& operator=(const RMCInput&);
   
-  void buildValueArrays();
+  std::string getName(const int *offsets, int idx) const {
+    return std::string(_nameChars + offsets[idx], offsets[idx+1] - offsets[idx]);
+  }
+  
+  /// Volume a vehicle of the given capacity can pour at most for an order before the
+  /// concrete expires, using the closest station
+  int getMaxPour(int order, int capacity) const;
+  
+  /// Upper bound on the deliveries of a vehicle within the horizon
+  int computeVehicleMaxDeliveries(int vehicle) const;
+  
+  /// Compute delivery bounds, vehicle classes and the horizon of a loaded instance. Deadlines
+  /// of orders are limited by deadlineLimits, if given.
+  void computeBounds(InstanceHeader *header, const int *deadlineLimits);
+  
+  /// Tighten the horizon and the deadlines of orders using a list schedule
+  void computeHorizon(int *deadlines, const int *deadlineLimits);
+  
+  /// Smallest and largest capacity of the vehicles that can serve an order, 0 if there are none
+  void getCompatibleCapacities(int order, int &minCapacity, int &maxCapacity) const;
   
-  std::vector<Order*> _orders;
-  std::vector<Vehicle*> _vehicles;
-  std::vector<Station*> _stations;
+  /// Copy the given orders and vehicles of another instance, with all durations scaled
+  /// down by granularity, and compute the bounds
+  bool extractProblem(const RMCInput &input, const std::vector<int> &orders, const std::vector<int> &vehicles,
+                      int granularity);
   
-  std::map<std::string, int> _stationCodes;
+  /// Allocate an empty arena for the given sizes and set up the header
+  InstanceHeader *allocateArena(int numO, int numV, int numS, int numY, size_t nameChars);
+  
+  /// Point all columns into the arena
+  void attachArena(char *arena, size_t size, bool mapped);
+  
+  /// Free the arena and all data in it
+  void releaseArena();
+  
+  static bool isCompiled(const char *filename);
+  
+  bool loadCompiled(const char *filename);
+  
+  int _numOrders;
+  int _numVehicles;
+  int _numStations;
+  int _numYards;
   
   int _maxDeliveries;
   int _maxTimeStamp;
+  int _additiveTimeStamp;
+  int _heuristicCost;
   int _maxTravelTime;
+  int _timeMax;
+  int _timeScale;
   
   time_t _baseTimeStamp;
   
-  // Arrays 
-  int*   _orderStartTimes;
-  int*   _orderTotalVolumes;
-  int*   _orderReqDischargeRates;
-  int*   _orderReqPipeLength;
-  int*   _orderSetupTimes;
-  int*   _orderPreferredStations;
-  
-  int*   _stationLoadTimes;
+  // Block holding the header and all columns
+  char*  _arena;
+  size_t _arenaSize;
+  // true if the arena is a memory mapped compiled instance
+  bool   _arenaMapped;
+  
+  // Columns, pointing into the arena
+  const int*  _orderStartTimes;
+  const int*  _orderTotalVolumes;
+  const int*  _orderReqDischargeRates;
+  const int*  _orderReqPipeLength;
+  const int*  _orderSetupTimes;
+  const int*  _orderPreferredStations;
+  const int*  _orderMaxVolumeAllowed;
+  const int*  _orderYards;
+  const int*  _orderMaxDeliveries;
+  const int*  _orderMinDeliveries;
+  const int*  _orderDeadlines;
+  const int*  _orderDeliveryOffsets;
+  
+  const int*  _vehiclePumpLengths;
+  const int*  _vehicleDischargeRates;
+  const int*  _vehicleNormalVolumes;
+  const int*  _vehicleMaxVolumes;
+  const int*  _vehicleAvailableFrom;
+  const int*  _vehicleMaxDeliveries;
+  const int*  _vehicleClasses;
+  const int*  _vehicleDeliveryOffsets;
+  
+  const int*  _stationLoadTimes;
   
   // orders * vehicles  
-  int*   _orderVehicleVolumes;
-  
-  // orders * stations
-  int*   _travelTimesTo;
-  int*   _travelTimesFrom;
+  const int*  _orderVehicleVolumes;
+  const int*  _orderVehicleCompatible;
+  
+  // yards * stations
+  const int*  _travelTimesTo;
+  const int*  _travelTimesFrom;
+  
+  const int*  _orderNames;
+  const int*  _vehicleNames;
+  const int*  _stationNames;
+  const int*  _yardNames;
+  const char* _nameChars;
 };
 
+
+inline std::string Order::name() const { return _input->getOrderName(_idx); }
+
+inline int Order::requiredPumpLength() const { return _input->getOrderReqPipeLengths()[_idx]; }
+
+inline int Order::totalVolume() const { return _input->getOrderTotalVolumes()[_idx]; }
+
+inline int Order::preferredStation() const { return _input->getOrderPreferredStations()[_idx]; }
+
+inline int Order::timeStart() const { return _input->getOrderStartTimes()[_idx]; }
+
+inline int Order::dTimeSetup() const { return _input->getOrderSetupTimes()[_idx]; }
+
+inline int Order::dischargeRate() const { return _input->getOrderReqDischargeRates()[_idx]; }
+
+inline bool Order::maxVolumeAllowed() const { return _input->getOrderMaxVolumeAllowed()[_idx] != 0; }
+
+inline int Order::yard() const { return _input->getOrderYards()[_idx]; }
+
+
+inline std::string Vehicle::name() const { return _input->getVehicleName(_idx); }
+
+inline int Vehicle::pumpLength() const { return _input->getVehiclePumpLengths()[_idx]; }
+
+inline int Vehicle::maxDischargeRate() const { return _input->getVehicleDischargeRates()[_idx]; }
+
+inline int Vehicle::volume(bool maxVolume) const {
+  int normalVolume = _input->getVehicleNormalVolumes()[_idx];
+  int maxVol = _input->getVehicleMaxVolumes()[_idx];
+  if (maxVol == normalVolume) {
+    return maxVol;
+  }
+  if (maxVolume && maxVol) {
+    return maxVol;
+  }
+  return normalVolume;
+}
+
+inline int Vehicle::availableFrom() const { return _input->getVehicleAvailableFrom()[_idx]; }
+
+
+inline std::string Station::name() const { return _input->getStationName(_idx); }
+
+inline int Station::loadingMinutes() const { return _input->getStationLoadTimes()[_idx]; }
+
+
 class RMCOutput {
   
 };
@@ -1,523 +1,708 @@
 
-#include "Problem.hpp"
-
-#include <gecode/int.hh>
-#include <gecode/minimodel.hh>
-#include <gecode/driver.hh>
+#include "RMC.hpp"
+#include "CostBound.hpp"
+#include "Decompose.hpp"
+#include "Greedy.hpp"
+#include "LNS.hpp"
+#include "OrderSequence.hpp"
+#include "Parallel.hpp"
+#include "Portfolio.hpp"
+#include "ReadXML.hpp"
+#include "RMCOrders.hpp"
+#include "SerialSchedule.hpp"
+#include "SumByKey.hpp"
+#include "VehicleChain.hpp"
 
 #include <gecode/gist.hh>
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 
-using namespace Gecode;
+/// Failures allowed when completing the warm start schedule to a first solution
+static const int WARMSTART_FAIL_LIMIT = 10000;
+
+/// Share of the time limit for the search on the coarse time grid, the fine search gets the rest
+static const double COARSE_TIME_SHARE = 0.25;
 
-class RMCOptions : public InstanceOptions {
-private:
-  RMCInput &Input;
-public:
-  RMCOptions(const char *name, RMCInput &input) 
-  : InstanceOptions(name), Input(input) {}
+RMC::RMC(const RMCOptions &opt) 
+: Deliveries(*this, opt.getInput().getNumVehicles(), 0, opt.getInput().getMaxDeliveries()),
+  D_Order(*this, opt.getInput().getMaxTotalDeliveries(), 0, opt.getInput().getNumOrders() - 1),
+  D_Station(*this, opt.getInput().getMaxTotalDeliveries(), 0, opt.getInput().getNumStations() - 1),
+  D_tLoad(*this, opt.getInput().getMaxTotalDeliveries(), 0, opt.getInput().getMaxTimeStamp()),
+  D_tUnload(*this, opt.getInput().getMaxTotalDeliveries(), 0, opt.getInput().getMaxTimeStamp()),
+  Cost(*this, 0, Int::Limits::max),
+  O_Poured(*this, opt.getInput().getNumOrders(), 1, Int::Limits::max),
+  O_Deliveries(*this, opt.getInput().getNumOrders(), 1, opt.getInput().getMaxDeliveries()),
+  O_Waste(*this, opt.getInput().getNumOrders(), 0, Int::Limits::max),
+  O_Lateness(*this, opt.getInput().getNumOrders(), 0, Int::Limits::max),
   
-  void loadProblem() {
-    Input.loadProblem(instance());
-  }
+  O_tLag(*this, opt.getInput().getNumOrders(), 0, Int::Limits::max),
+  O_Preferred(*this, opt.getInput().getMaxTotalDeliveries(), 0, 1),
+  Input(&opt.getInput()), SolutionFile(opt.solutionFile())
+{
+  const RMCInput &input = opt.getInput();
   
-  const RMCInput &getInput() const { return Input; }
-};
-
-class RMC : public MinimizeScript {
+  int numV = input.getNumVehicles();
+  int numO = input.getNumOrders();
+  int numS = input.getNumStations();
+  // Delivery slots per vehicle, the rows of the per delivery arrays have different lengths.
+  // Row i starts at V_first[i] and has V_numD[i] entries.
+  const int *V_first = input.getVehicleDeliveryOffsets();
+  const int *V_numD = input.getVehicleMaxDeliveries();
+  // Delivery slots of all vehicles
+  int numD = input.getMaxTotalDeliveries();
   
-protected:
+  // Maximum number of deliveries per order
+  const int *O_numD = input.getOrderMaxDeliveries();
   
-  // ------------- Decision Variables ----------------
+  // Set boolean flags for all active deliveries
+  BoolVarArgs D_Used(*this, numD, 0, 1);
   
-  // Number of deliveries per vehicle
-  IntVarArray Deliveries;
+  for (int i = 0; i < numV; i++) {
+    rel(*this, Deliveries[i] <= V_numD[i]);
+    for (int d = 0; d < V_numD[i]; d++) {
+      int k = V_first[i] + d;
+      rel(*this, D_Used[k] == (d < Deliveries[i]));
+    }
+  }
   
-  // Order number per delivery (i * numV + d)
-  IntVarArray D_Order;
+  // Vehicles can only deliver to orders they are compatible with. Unused deliveries are
+  // set to order 0, so 0 stays in the domain of vehicles that can not serve order 0.
+  const int *compatible = input.getOrderVehicleCompatible();
+  for (int i = 0; i < numV; i++) {
+    if (V_numD[i] == 0) continue;
+    
+    IntArgs orders;
+    orders << 0;
+    for (int o = 1; o < numO; o++) {
+      if (compatible[o * numV + i]) orders << o;
+    }
+    dom(*this, D_Order.slice(V_first[i], 1, V_numD[i]), IntSet(orders));
+    
+    if (!compatible[i]) {
+      for (int d = 0; d < V_numD[i]; d++) {
+        int k = V_first[i] + d;
+        rel(*this, D_Used[k] >> (D_Order[k] != 0));
+      }
+    }
+  }
   
-  // Index of start station
-  IntVarArray D_Station;
+  // Equivalent vehicles are interchangeable, order them lexicographically by number of deliveries
+  // and orders. All vehicles of a class have the same number of slots.
+  const int *V_classes = input.getVehicleClasses();
+  std::vector<int> lastOfClass(numV, -1);
+  for (int i = 0; i < numV; i++) {
+    int prev = lastOfClass[V_classes[i]];
+    lastOfClass[V_classes[i]] = i;
+    if (prev == -1) continue;
+    
+    IntVarArgs prevTour, tour;
+    prevTour << Deliveries[prev] << D_Order.slice(V_first[prev], 1, V_numD[prev]);
+    tour     << Deliveries[i]    << D_Order.slice(V_first[i], 1, V_numD[i]);
+    rel(*this, prevTour, IRT_GQ, tour);
+  }
   
-  // Timestamp when loading starts for delivery d
-  IntVarArray D_tLoad;
+  // Force all unused deliveries to some value
+  for (int i = 0; i < numV; i++) {
+    for (int d = 0; d < V_numD[i]; d++) {
+      int k = V_first[i] + d;
+      rel(*this, D_Used[k] || (D_Order[k] == 0));
+      rel(*this, D_Used[k] || (D_Station[k] == 0));
+      rel(*this, D_Used[k] || (D_tLoad[k] == 0));
+      rel(*this, D_Used[k] || (D_tUnload[k] == 0));
+    }
+  }
   
-  // Timestamp when unloading starts for delivery d
-  IntVarArray D_tUnload;
+  /// ----- helper variables per delivery -----
+
+  // Start times of orders
+  IntArgs O_tStart(input.getNumOrders(), input.getOrderStartTimes() );
   
-  // --------------- Optimization Goal ---------------
+  // Required discharge rates of orders
+  IntArgs O_reqDischargeRates(input.getNumOrders(), input.getOrderReqDischargeRates());
   
-  // Cost function value
-  IntVar Cost;
+  IntArgs O_preferredStation(input.getNumOrders(), input.getOrderPreferredStations());
   
-  // --------------- Result values -------------------
+  // Setup time per order
+  IntArgs O_dT_setup(input.getNumOrders(), input.getOrderSetupTimes());
   
-  // Total amount of concrete poured per order
-  IntVarArray O_Poured;
-
-  // Amount of deliveries per order
-  IntVarArray O_Deliveries;
+  // Total volume to pour per order
+  IntArgs O_totalVolumes(input.getNumOrders(), input.getOrderTotalVolumes());
   
-  // Amount of waste per order
-  IntVarArray O_Waste;
+  // Travel time from stations to yards, per order
+  IntArgs O_dt_travelTo(numO * numS);
   
-  // Lateness of orders
-  IntVarArray O_Lateness;
+  // Travel time from yards to stations, per order
+  IntArgs O_dt_travelFrom(numO * numS);
   
-  IntVarArray ODMap;
-  IntVarArray O_tLag;
-  IntVarArray O_tUnload;
-  BoolVarArray O_Preferred;
-public:
-  /// problem construction
-
-  RMC(const RMCOptions &opt) 
-  : Deliveries(*this, opt.getInput().getNumVehicles(), 0, opt.getInput().getNumOrders() * opt.getInput().getMaxDeliveries() - 1),
-    D_Order(*this, opt.getInput().getMaxTotalDeliveries(), 0, opt.getInput().getNumOrders() - 1),
-    D_Station(*this, opt.getInput().getMaxTotalDeliveries(), 0, opt.getInput().getNumStations() - 1),
-    D_tLoad(*this, opt.getInput().getMaxTotalDeliveries(), 0, opt.getInput().getMaxTimeStamp()),
-    D_tUnload(*this, opt.getInput().getMaxTotalDeliveries(), 0, opt.getInput().getMaxTimeStamp()),
-    Cost(*this, 0, Int::Limits::max),
-    O_Poured(*this, opt.getInput().getNumOrders(), 1, Int::Limits::max),
-    O_Deliveries(*this, opt.getInput().getNumOrders(), 1, opt.getInput().getMaxDeliveries()),
-    O_Waste(*this, opt.getInput().getNumOrders(), 0, Int::Limits::max),
-    O_Lateness(*this, opt.getInput().getNumOrders(), 0, Int::Limits::max),
-    
-    ODMap(*this, opt.getInput().getMaxTotalDeliveries(), 0, opt.getInput().getMaxTotalDeliveries() - 1),
-    O_tLag(*this, opt.getInput().getMaxTotalDeliveries(), 0, Int::Limits::max),
-    O_tUnload(*this, opt.getInput().getMaxTotalDeliveries(), 0, Int::Limits::max),
-    O_Preferred(*this, opt.getInput().getMaxTotalDeliveries(), 0, 1)
-  {
-    const RMCInput &input = opt.getInput();
-    
-    int numD = input.getMaxDeliveries();
-    int numV = input.getNumVehicles();
-    int numO = input.getNumOrders();
-    int numS = input.getNumStations();
-    int numVD = numO * numD;
-    int numOD = numV * numD;
-    
-    // Note: Gecode uses COLUMN first, then ROW as arguments to Matrix.
-    
-    // Create a matrix view on all the delivery variables
-    Matrix<IntVarArray> mD_Order(D_Order, numVD, numV);
-    Matrix<IntVarArray> mD_Station(D_Station, numVD, numV);
-    Matrix<IntVarArray> mD_tLoad(D_tLoad, numVD, numV);
-    Matrix<IntVarArray> mD_tUnload(D_tUnload, numVD, numV);
-    
-    // Set boolean flags for all active deliveries
-    BoolVarArgs D_Used(*this, numV * numVD, 0, 1);
-    Matrix<BoolVarArgs> mD_Used(D_Used, numVD, numV);
-    
-    for (int i = 0; i < numV; i++) {
-      for (int d = 0; d < numVD; d++) {
-        rel(*this, mD_Used(d, i) == (d < Deliveries[i]));
-      }
-    }
-    
-    // Force all unused deliveries to some value
-    for (int i = 0; i < numV; i++) {
-      for (int d = 0; d < numVD; d++) {
-        rel(*this, mD_Used(d, i) || (mD_Order(d, i) == 0));
-        rel(*this, mD_Used(d, i) || (mD_Station(d, i) == 0));
-        rel(*this, mD_Used(d, i) || (mD_tLoad(d, i) == 0));
-        rel(*this, mD_Used(d, i) || (mD_tUnload(d, i) == 0));
-      }
-    }
-    
-    /// ----- helper variables per delivery -----
-
-    // Start times of orders
-    IntArgs O_tStart(input.getNumOrders(), input.getOrderStartTimes() );
-    
-    // Required discharge rates of orders
-    IntArgs O_reqDischargeRates(input.getNumOrders(), input.getOrderReqDischargeRates());
-    
-    // Required volumes of orders
-    IntArgs O_reqPipeLengths(input.getNumOrders(), input.getOrderReqPipeLengths());
-    
-    IntArgs O_preferredStation(input.getNumOrders(), input.getOrderPreferredStations());
-    
-    // Setup time per order
-    IntArgs O_dT_setup(input.getNumOrders(), input.getOrderSetupTimes());
-    
-    // Total volume to pour per order
-    IntArgs O_totalVolumes(input.getNumOrders(), input.getOrderTotalVolumes());
-    
-    // Volume of vehicles per order
-    IntArgs V_volumes(input.getNumOrders() * input.getNumVehicles(), input.getOrderVehicleVolumes());
-    
-    // Travel time from stations to yards
-    IntArgs O_dt_travelTo(input.getNumOrders() * input.getNumStations(), input.getTravelTimesToYards());
-    
-    // Travel time from yards to stations
-    IntArgs O_dt_travelFrom(input.getNumOrders() * input.getNumStations(), input.getTravelTimesFromYards());
-    
-    // Station load times
-    IntArgs S_tLoad(input.getNumStations(), input.getStationLoadTimes());
-        
-    
-    // Time to travel to yard
-    IntVarArgs D_dT_travelTo(*this, numV * numVD, 0, Int::Limits::max);
-    Matrix<IntVarArgs> mD_dT_travelTo(D_dT_travelTo, numVD, numV);
-    
-    for (int i = 0; i < numV * numVD; i++) {
-      rel(*this, (D_dT_travelTo[i] == element(O_dt_travelTo, D_Order[i] * numS + D_Station[i]) && D_Used[i]) ||
-                 (D_dT_travelTo[i] == 0 && !D_Used[i]));
-    }
-    
-    // Time to travel back to station
-    // We ignore the trip back from the last delivery.. since the time to travel back
-    // only depends on the station to travel to, we can just assume we travel back to a fixed station and eliminate this value    
-    IntVarArgs D_dT_travelFrom(*this, numV * numVD, 0, Int::Limits::max);
-    Matrix<IntVarArgs> mD_dT_travelFrom(D_dT_travelFrom, numVD, numV);
-    
-    for (int i = 0; i < numV; i++) {
-      for (int d = 1; d < numVD; d++) {
-        rel(*this, (mD_dT_travelFrom(d-1, i) == element(O_dt_travelFrom, mD_Order(d-1, i) * numS + mD_Station(d, i)) && mD_Used(d, i)) ||
-                   (mD_dT_travelFrom(d-1, i) == 0 && !mD_Used(d, i)));
-      }
-      rel(*this, mD_dT_travelFrom(numVD-1, i) == 0);
+  for (int i = 0; i < numO; i++) {
+    for (int j = 0; j < numS; j++) {
+      O_dt_travelTo  [i * numS + j] = input.getTravelTimeTo(i, j);
+      O_dt_travelFrom[i * numS + j] = input.getTravelTimeFrom(i, j);
     }
+  }
+  
+  // Station load times
+  IntArgs S_tLoad(input.getNumStations(), input.getStationLoadTimes());
+      
+  
+  // Time to travel to yard, restricted by the vehicle chain below
+  IntVarArgs D_dT_travelTo(*this, numD, 0, input.getMaxTravelTime());
+  
+  // Time to travel back to station
+  // We ignore the trip back from the last delivery.. since the time to travel back
+  // only depends on the station to travel to, we can just assume we travel back to a fixed station and eliminate this value    
+  IntVarArgs D_dT_travelFrom(*this, numD, 0, input.getMaxTravelTime());
 
-    // Timestamp of arrival at yard
-    IntVarArgs D_t_arrival(*this, numV * numVD, 0, Int::Limits::max);
-    Matrix<IntVarArgs> mD_t_arrival(D_t_arrival, numVD, numV);
-    
-    for (int i = 0; i < numV * numVD; i++) {
-      rel(*this, (D_t_arrival[i] == D_tLoad[i] + element(S_tLoad, D_Station[i]) + D_dT_travelTo[i] && D_Used[i]) ||
-                 (D_t_arrival[i] == 0 && !D_Used[i]) );
+  int maxVolume = 0;
+  for (int k = 0; k < numO * numV; k++) {
+    maxVolume = std::max(maxVolume, input.getOrderVehicleVolumes()[k]);
+  }
+  
+  // Amount of concrete delivered by a delivery 
+  IntVarArgs D_delivered(*this, numD, 0, maxVolume);
+  
+  for (int i = 0; i < numV; i++) {
+    // Volume of the vehicle per order
+    IntArgs volumes(numO);
+    for (int o = 0; o < numO; o++) {
+      volumes[o] = input.getOrderVehicleVolumes()[o * numV + i];
     }
-
-    // Amount of concrete delivered by a delivery 
-    IntVarArgs D_delivered(*this, numV * numVD, 0, Int::Limits::max);
-    Matrix<IntVarArgs> mD_delivered(D_delivered, numVD, numV);
     
-    for (int i = 0; i < numV; i++) {
-      for (int d = 0; d < numVD; d++) {
-        rel(*this, (mD_delivered(d, i) == element(V_volumes, mD_Order(d, i) * numV + i) && mD_Used(d, i)) ||
-                   (mD_delivered(d, i) == 0 && !mD_Used(d, i)));
-      }
+    for (int d = 0; d < V_numD[i]; d++) {
+      int k = V_first[i] + d;
+      rel(*this, (D_delivered[k] == element(volumes, D_Order[k]) && D_Used[k]) ||
+                 (D_delivered[k] == 0 && !D_Used[k]));
     }
-    
-    // Time required for unloading
-    // TODO in case D_tUnload + D_dT_Unloading - D_tLoad > Tmax, we might unload faster, but we do not want this anyway.
-    
-    IntVarArgs D_dT_Unloading(*this, numV * numVD, 0, Int::Limits::max);
-    Matrix<IntVarArgs> mD_dT_Unloading(D_dT_Unloading, numVD, numV);
-    
-    for (int i = 0; i < numV; i++) {
-      for (int d = 0; d < numVD; d++) {
-        rel(*this, mD_dT_Unloading(d, i) == mD_delivered(d, i) / element(O_reqDischargeRates, mD_Order(d, i)));
-      }
+  }
+  
+  // Time required for unloading
+  // TODO in case D_tUnload + D_dT_Unloading - D_tLoad > Tmax, we might unload faster, but we do not want this anyway.
+  
+  IntVarArgs D_dT_Unloading(*this, numD, 0, input.getMaxUnloadingTime());
+  
+  for (int i = 0; i < numV; i++) {
+    // Unloading time of the vehicle per order
+    IntArgs unloading(numO);
+    for (int o = 0; o < numO; o++) {
+      unloading[o] = input.getUnloadingTime(o, i);
     }
     
-    // Amount of concrete poured by a delivery (excluding bad concrete)
-    IntVarArgs D_poured(*this, numV * numVD, 0, Int::Limits::max);
-    Matrix<IntVarArgs> mD_poured(D_poured, numVD, numV);
-    
-    for (int i = 0; i < numV; i++) {
-      for (int d = 0; d < numVD; d++) {
-        rel(*this, mD_poured(d, i) == min( mD_delivered(d, i), 
-                                          (input.getTimeMax() - mD_tUnload(d, i) + mD_tLoad(d, i)) * 
-                                              element(O_reqDischargeRates, mD_Order(d, i)) 
-                                        ) );
-      }
+    for (int d = 0; d < V_numD[i]; d++) {
+      int k = V_first[i] + d;
+      rel(*this, (D_dT_Unloading[k] == element(unloading, D_Order[k]) && D_Used[k]) ||
+                 (D_dT_Unloading[k] == 0 && !D_Used[k]));
     }
-    
-    // Total amount poured per order
-    for (int i = 0; i < numO; i++) {
-      const Order &o = input.getOrder(i);
-      
-      IntVarArgs volume(*this, numV * numVD, 0, Int::Limits::max);
-      
-      for (int d= 0; d < numV * numVD; d++) {
-        // Only in Gecode 4.2
-        // ite(*this, D_Order[d] == i, D_poured[d], 0, volume[d]);
-        
-        rel(*this, (volume[d] == D_poured[d] && D_Order[d] == i) ||
-                   (volume[d] == 0 && D_Order[d] != i));
-      }
-      
-      rel(*this, O_Poured[i] == sum(volume));
+  }
+  
+  // Amount of concrete poured by a delivery (excluding bad concrete)
+  IntVarArgs D_poured(*this, numD, 0, maxVolume);
+  
+  for (int i = 0; i < numV; i++) {
+    for (int d = 0; d < V_numD[i]; d++) {
+      int k = V_first[i] + d;
+      rel(*this, D_poured[k] == min( D_delivered[k], 
+                                     (input.getTimeMax() - D_tUnload[k] + D_tLoad[k]) * 
+                                         element(O_reqDischargeRates, D_Order[k]) 
+                                   ) );
     }
+  }
+  
+  // Total amount poured per order. Unused deliveries pour nothing, deliveries of vehicles that can not
+  // serve an order never take it by the domains of D_Order.
+  sumByKey(*this, D_Order, D_poured, O_Poured);
 
 
-    // Deliveries per order
-    for (int i = 1; i < numO; i++) {
-      count(*this, D_Order, i, IRT_EQ, O_Deliveries[i]);
+  // Deliveries per order
+  for (int i = 1; i < numO; i++) {
+    IntVarArgs orders;
+    for (int v = 0; v < numV; v++) {
+      if (compatible[i * numV + v]) orders << D_Order.slice(V_first[v], 1, V_numD[v]);
     }
-    // Order 0 is special, need to substract all unused deliveries
-    IntVar tmpCount(*this, 0, numV * numVD);
-    count(*this, D_Order, 0, IRT_EQ, tmpCount);
-    rel(*this, O_Deliveries[0] == tmpCount - (numV * numVD - sum(D_Used)));
-    
-    
-    /// ---- add constraints ----
+    count(*this, orders, i, IRT_EQ, O_Deliveries[i]);
+  }
+  // Order 0 is special, need to substract all unused deliveries
+  IntVar tmpCount(*this, 0, numD);
+  count(*this, D_Order, 0, IRT_EQ, tmpCount);
+  rel(*this, O_Deliveries[0] == tmpCount - (numD - sum(D_Used)));
+  
+  
+  /// ---- add constraints ----
+  
+  // Unloading must not start before the order starts, nor after its deadline
+  IntArgs O_deadlines(numO, input.getOrderDeadlines());
+  for (int d = 0; d < numD; d++) {
+    rel(*this, D_tUnload[d] >= element(O_tStart, D_Order[d]) || !D_Used[d]);
+    rel(*this, D_tUnload[d] <= element(O_deadlines, D_Order[d]) || !D_Used[d]);
+  }
+ 
+  // Vehicles start at station 0
+  for (int i = 0; i < numV; i++) {
+    if (V_numD[i] == 0) continue;
+    rel(*this, D_Station[V_first[i]] == 0);
+  }
+  
+  // Vehicles must have the required pipeline length and discharge rate for their orders,
+  // this is ensured by the domains of D_Order.
+  
+  // Travel times, loading only after the vehicle arrived back at the station, unloading only after
+  // the vehicle arrived at the yard, and loading of vehicle i not before V_i.available
+  const int *V_available = input.getVehicleAvailableFrom();
+  for (int i = 0; i < numV; i++) {
+    if (V_numD[i] == 0) continue;
+    vehicleChain(*this, D_Order.slice(V_first[i], 1, V_numD[i]), D_Station.slice(V_first[i], 1, V_numD[i]),
+                 D_tLoad.slice(V_first[i], 1, V_numD[i]), D_tUnload.slice(V_first[i], 1, V_numD[i]),
+                 D_dT_Unloading.slice(V_first[i], 1, V_numD[i]),
+                 D_dT_travelTo.slice(V_first[i], 1, V_numD[i]), D_dT_travelFrom.slice(V_first[i], 1, V_numD[i]),
+                 D_Used.slice(V_first[i], 1, V_numD[i]),
+                 S_tLoad, O_dT_setup, O_dt_travelTo, O_dt_travelFrom, V_available[i]);
+  }
+      
+  // Only one vehicle can be loaded at a station at a time
+  for (int i = 0; i < input.getNumStations(); i++) {
+    const Station &s = input.getStation(i);
     
-    // Loading of vehicle i must not start before V_i.available
-    for (int i = 0; i < numV; i++) {
-      rel(*this, (mD_tLoad(0, i) >= input.getVehicle(i).availableFrom()) || !mD_Used(0, i));
-    }
+    // True for every delivery loaded at station i
+    BoolVarArgs AtStation(*this, numD, 0, 1);
+    IntArgs LoadTime = IntArgs::create(numD, s.loadingMinutes(), 0);
     
-    // Unloading must not start before the order starts
-    for (int d = 0; d < numV * numVD; d++) {
-      rel(*this, D_tUnload[d] >= element(O_tStart, D_Order[d]) || !D_Used[d]);
-    }
-   
-    // Vehicles start at station 0
-    for (int i = 0; i < numV; i++) {
-      rel(*this, mD_Station(0, i) == 0);
+    for (int d = 0; d < numD; d++) {
+      rel(*this, AtStation[d] == (D_Station[d] == i && D_Used[d]));
     }
     
-    // Vehicle must have required pipeline length and discharge rate for orders
-    for (int i = 0; i < numV; i++) {
-      const Vehicle &v = input.getVehicle(i);
-      for (int d = 0; d < numVD; d++) {
-        rel(*this, element(O_reqPipeLengths, mD_Order(d, i)) <= v.pumpLength() || !mD_Used(d, i));
-        rel(*this, element(O_reqDischargeRates, mD_Order(d, i)) <= v.maxDischargeRate() || !mD_Used(d, i));
-      }
+    unary(*this, D_tLoad, LoadTime, AtStation);
+  }
+  
+  // Only one vehicle can be unloaded at a construction yard at a time. Unloading is an optional
+  // task on the yard of every order the vehicle can serve.
+  IntVarArgs D_t_unloaded(*this, numD, 0, input.getMaxTimeStamp() + input.getMaxUnloadingTime());
+
+  for (int d = 0; d < numD; d++) {
+    rel(*this, D_t_unloaded[d] == D_tUnload[d] + D_dT_Unloading[d]);
+  }
+  
+  for (int y = 0; y < input.getNumYards(); y++) {
+    IntArgs yardOrders;
+    for (int i = 0; i < numO; i++) {
+      if (input.getOrderYards()[i] == y) yardOrders << i;
     }
+    if (yardOrders.size() == 0) continue;
     
-    // Loading can only start after vehicle arrived back at the station
-    for (int i = 0; i < numV; i++) {
-      for (int d = 1; d < numVD; d++) {
-        rel(*this, mD_tUnload(d-1, i) + mD_dT_Unloading(d-1, i) + mD_dT_travelFrom(d-1, i) <= mD_tLoad(d, i) || !mD_Used(d, i));
-      }
-    }
+    IntVarArgs start, duration, end;
+    BoolVarArgs AtYard;
     
-    // Unloading can only start after the vehicle arrived at the yard
     for (int i = 0; i < numV; i++) {
-      for (int d = 0; d < numVD; d++) {
-        rel(*this, mD_t_arrival(d, i) <= mD_tUnload(d, i) - element(O_dT_setup, D_Order[i]) || !mD_Used(d, i));
+      bool serves = false;
+      for (int j = 0; j < yardOrders.size(); j++) {
+        serves = serves || compatible[yardOrders[j] * numV + i];
       }
-    }
-        
-    // Only one vehicle can be loaded at a station at a time
-    for (int i = 0; i < input.getNumStations(); i++) {
-      const Station &s = input.getStation(i);
+      if (!serves) continue;
       
-      // True for every delivery loaded at station i
-      BoolVarArgs AtStation(*this, numV * numVD, 0, 1);
-      IntArgs LoadTime = IntArgs::create(numV * numVD, s.loadingMinutes(), 0);
-      
-      for (int d = 0; d < numV * numVD; d++) {
-        rel(*this, AtStation[d] == (D_Station[d] == i && D_Used[d]));
+      for (int d = 0; d < V_numD[i]; d++) {
+        int k = V_first[i] + d;
+        BoolVar forYard(*this, 0, 1);
+        BoolVar atYard(*this, 0, 1);
+        dom(*this, D_Order[k], IntSet(yardOrders), forYard);
+        rel(*this, atYard == (forYard && D_Used[k]));
+        
+        start << D_tUnload[k];
+        duration << D_dT_Unloading[k];
+        end << D_t_unloaded[k];
+        AtYard << atYard;
       }
-      
-      unary(*this, D_tLoad, LoadTime, AtStation);
     }
     
-    // Only one vehicle can be unloaded at a construction site at a time
-    // TODO this should be per construction yard, not order
-    IntVarArgs D_t_unloaded(*this, numV * numVD, 0, Int::Limits::max);
-
-    for (int d = 0; d < numV * numVD; d++) {
-      rel(*this, D_t_unloaded[d] == D_tUnload[d] + D_dT_Unloading[d]);
+    if (start.size() > 1) {
+      unary(*this, start, duration, end, AtYard);
     }
-    
-    for (int i = 0; i < numO; i++) {
-      const Order &o = input.getOrder(i);
-      
-      BoolVarArgs AtYard(*this, numV * numVD, 0, 1);
-      
-      for (int d = 0; d < numV * numVD; d++) {
-        rel(*this, D_t_unloaded[d] == D_tUnload[d] + D_dT_Unloading[d]);
-      }
+  }
+  
+  // All orders must be fullfilled
+  for (int i = 0; i < numO; i++) {
+    const Order &o = input.getOrder(i);
+    rel(*this, O_Poured[i] >= o.totalVolume());
+  }
       
-      unary(*this, D_tUnload, D_dT_Unloading, D_t_unloaded, AtYard);
-    }
-    
-    // All orders must be fullfilled
-    for (int i = 0; i < numO; i++) {
-      const Order &o = input.getOrder(i);
-      rel(*this, O_Poured[i] >= o.totalVolume());
-    }
-        
-    // Minimum number of deliveries per order
-    for (int i = 0; i < numO; i++) {
-      rel(*this, O_Deliveries[i] >= input.getMinDeliveries(i));
-    }    
+  // Minimum and maximum number of deliveries per order
+  for (int i = 0; i < numO; i++) {
+    rel(*this, O_Deliveries[i] >= input.getMinDeliveries(i));
+    rel(*this, O_Deliveries[i] <= O_numD[i]);
+  }    
+  
+  // Deliveries per vehicle are bounded by total deliveries per orders
+  for (int i = 0; i < numV; i++) {
+    rel(*this, Deliveries[i] <= sum(O_Deliveries));
+  }
+  
+  /// ------ define cost function ----
+  
+  // Calculate waste
+  for (int i = 0; i < numO; i++) {
+    const Order &o = input.getOrder(i);
     
-    // Deliveries per vehicle are bounded by total deliveries per orders
+    rel(*this, O_Waste[i] == O_Poured[i] - o.totalVolume());
+  }
+  
+  // Calculate preferred stations
+  //BoolVarArgs Preferred(*this, numD, 0, 1);
+  
+  for (int d = 0; d < numD; d++) {
+    rel(*this, O_Preferred[d] == (D_Station[d] != element(O_preferredStation, D_Order[d]) && D_Used[d]) );
+  }
+  
+  
+  // Calculate lateness of the first delivery and time lags between the deliveries per order,
+  // over the deliveries of each order sorted by their unloading times
+  orderSequence(*this, D_Order, D_Used, D_tUnload, D_dT_Unloading, O_tStart, O_Lateness, O_tLag);
+
+  // Total costs
+  rel(*this, Cost == sum(O_Lateness) * input.getAlpha1() + sum(O_Waste) * input.getAlpha2() +
+                     sum(O_Preferred) * input.getAlpha3() + sum(O_tLag) * input.getAlpha4() +
+                     (sum(D_dT_travelTo) + sum(D_dT_travelFrom)) * input.getAlpha5());
+  
+  postCostBounds(input, Cost, O_Poured, O_Waste, O_Lateness, O_tLag, O_Preferred,
+                 D_dT_travelTo, D_dT_travelFrom, O_Deliveries);
+
+  if (opt.getCostBound() >= 0) {
+    rel(*this, Cost <= opt.getCostBound());
+  }
+  
+  /// ----------- branching -----------
+  
+  // Try the assignment of the warm start schedule first
+  if (opt.getWarmStart()) {
+    IntArgs wsDeliveries = IntArgs::create(numV, 0, 0);
+    IntArgs wsOrder      = IntArgs::create(numD, 0, 0);
+    IntArgs wsStation    = IntArgs::create(numD, 0, 0);
+    IntArgs wsLoad       = IntArgs::create(numD, 0, 0);
+    IntArgs wsUnload     = IntArgs::create(numD, 0, 0);
+    
+    std::vector<ScheduledDelivery> deliveries;
     for (int i = 0; i < numV; i++) {
-      rel(*this, Deliveries[i] <= sum(O_Deliveries));
-    }
-    
-    /// ------ define cost function ----
-    
-    // Calculate waste
-    for (int i = 0; i < numO; i++) {
-      const Order &o = input.getOrder(i);
+      opt.getWarmStart()->getVehicleDeliveries(i, deliveries);
       
-      rel(*this, O_Waste[i] == O_Poured[i] - o.totalVolume());
-    }
-    
-    // Calculate preferred stations
-    //BoolVarArgs Preferred(*this, numV * numVD, 0, 1);
-    
-    for (int d = 0; d < numV * numVD; d++) {
-      rel(*this, O_Preferred[d] == (D_Station[d] != element(O_preferredStation, D_Order[d]) && D_Used[d]) );
-    }
-    
-    
-    // Calculate lateness of first delivery and time lag of other deliveries
-    //IntVarArgs O_tLag(*this, numO * numOD, 0, Int::Limits::max);
-    Matrix<IntVarArgs> mO_tLag(O_tLag, numOD, numO); 
-    
-    // First create an array containing unloading start times per order
-    //IntVarArgs O_tUnload(*this, numO * numOD, 0, Int::Limits::max);
-    Matrix<IntVarArgs> mO_tUnload(O_tUnload, numOD, numO);
-    
-    // Enforce sorting of O_tUnload
-    for (int o = 0; o < numO; o++) {
-      for (int d = 1; d < numOD; d++) {
-        rel(*this, (mO_tUnload(d-1, o) < mO_tUnload(d, o)) || (d >= O_Deliveries[o]));
+      wsDeliveries[i] = std::min((int)deliveries.size(), V_numD[i]);
+      for (int d = 0; d < wsDeliveries[i]; d++) {
+        int k = V_first[i] + d;
+        wsOrder  [k] = deliveries[d].order;
+        wsStation[k] = deliveries[d].station;
+        wsLoad   [k] = deliveries[d].tLoad;
+        wsUnload [k] = deliveries[d].tUnload;
       }
     }
     
-    // Create a permutation of D_tUnload onto O_tUnload
-    //IntVarArgs ODMap(*this, numO * numOD, 0, numV * numVD - 1);
-    Matrix<IntVarArgs> mODMap(ODMap, numOD, numO);
-    
-    // - All values must be distinct
-    distinct(*this, ODMap);
-    
-    // - Map to deliveries from same order
-    for (int i = 0; i < numO; i++) {
-      for (int d = 0; d < numOD; d++) {
-        rel(*this, (element(D_Order, mODMap(d, i)) == i && d < O_Deliveries[i]) ||
-                   (element(D_Order, mODMap(d, i)) == 0 && d >= O_Deliveries[i]) );
-      }
-    }
-    // - Map unload times
-    for (int d = 0; d < numO * numOD; d++) {
-      rel(*this, element(D_tUnload, ODMap[d]) == O_tUnload[d]);
-    }
-    // - Break symmetries for unused deliveries
-    for (int i = 0; i < numO; i++) {
-      for (int d = 1; d < numOD; d++) {
-        // ODMap[o, d-1] < ODMap[o, d] if !Used[d-1]
-        rel(*this, mODMap(d-1, i) < mODMap(d, i) || d-1 < O_Deliveries[i]);
-      }
-    }
-    for (int i = 1; i < numO; i++) {
-      // ODMap[o-1, max] < ODMap[o, min(unused)]
-      rel(*this, mODMap(numOD-1, i-1) < element(ODMap, i * numOD + O_Deliveries[i]) || 
-                 O_Deliveries[i-1] == numOD-1 || O_Deliveries[i] == numOD-1);
-    }
-        
-    // Define Lateness per order and TimeLags per order over order unloading times
-    for (int i = 0; i < numO; i++) {
-      const Order &o = input.getOrder(i);
-      rel(*this, O_Lateness[i] == mO_tUnload(0, i) - o.timeStart());
-      
-      for (int d = 1; d < numOD; d++) {
-        rel(*this, ((mO_tLag(d, i) == mO_tUnload(d, i) - mO_tUnload(d-1, i) - element(D_dT_Unloading, mODMap(d, i))) && (d < O_Deliveries[i])) ||
-                   ((mO_tLag(d, i) == 0) && (d >= O_Deliveries[i])) );
-      }
-      rel(*this, mO_tLag(0, i) == 0);
-    }
-
-    // Total costs
-    rel(*this, Cost == sum(O_Lateness) * input.getAlpha1() + sum(O_Waste) * input.getAlpha2() +
-                       sum(O_Preferred) * input.getAlpha3() + sum(O_tLag) * input.getAlpha4() +
-                       (sum(D_dT_travelTo) + sum(D_dT_travelFrom)) * input.getAlpha5());
-
-    /// ----------- branching -----------
-    
-    IntArgs initDel(numV);
-    for (int i = 0; i < numV; i++) { 
-      initDel[0] = numO;
-    }
-    
+    branch(*this, Deliveries,  INT_VAR_NONE(), INT_VAL_NEAR_MAX(wsDeliveries));
+    branch(*this, D_Order,     INT_VAR_NONE(), INT_VAL_NEAR_MIN(wsOrder));
+    branch(*this, D_Station,   INT_VAR_NONE(), INT_VAL_NEAR_MIN(wsStation));
+    branch(*this, D_tUnload,   INT_VAR_NONE(), INT_VAL_NEAR_MIN(wsUnload));
+    branch(*this, D_tLoad,     INT_VAR_NONE(), INT_VAL_NEAR_MAX(wsLoad));
+  }
+  
+  IntArgs initDel(numV);
+  for (int i = 0; i < numV; i++) { 
+    initDel[0] = numO;
+  }
+  
+  // the serial schedule decides the delivery counts of the vehicles while building the tours
+  if (opt.branching() != BRANCH_SGS) {
     branch(*this, O_Deliveries,INT_VAR_NONE(), INT_VAL_RANGE_MIN());
     branch(*this, Deliveries,  INT_VAR_NONE(), INT_VAL_NEAR_MAX(initDel));
-    branch(*this, O_Lateness,  INT_VAR_NONE(), INT_VAL_MIN());
-    branch(*this, O_tLag,      INT_VAR_NONE(), INT_VAL_MIN());
+  }
+  
+  switch (opt.branching()) {
+  case BRANCH_TOURS:
     branch(*this, D_Order,     INT_VAR_NONE(), INT_VAL_MIN());
-    branch(*this, O_Poured,    INT_VAR_NONE(), INT_VAL_MIN());    
-    branch(*this, O_Preferred, INT_VAR_NONE(), INT_VAL_MIN());
     branch(*this, D_Station,   INT_VAR_NONE(), INT_VAL_MIN());
-    
     branch(*this, D_tUnload,   INT_VAR_NONE(), INT_VAL_MIN());
     branch(*this, D_tLoad,     INT_VAR_NONE(), INT_VAL_RANGE_MAX());
-    branch(*this, O_tUnload,   INT_VAR_NONE(), INT_VAL_MIN());
+    break;
+  case BRANCH_FIRST_FAIL:
+    branch(*this, D_Order,     INT_VAR_SIZE_MIN(), INT_VAL_MIN());
+    branch(*this, D_Station,   INT_VAR_SIZE_MIN(), INT_VAL_MIN());
+    branch(*this, D_tUnload,   INT_VAR_MIN_MIN(),  INT_VAL_MIN());
+    branch(*this, D_tLoad,     INT_VAR_NONE(),     INT_VAL_RANGE_MAX());
+    break;
+  case BRANCH_AFC:
+    branch(*this, D_Order,     INT_VAR_AFC_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_Station,   INT_VAR_AFC_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_tUnload,   INT_VAR_AFC_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_tLoad,     INT_VAR_NONE(), INT_VAL_RANGE_MAX());
+    break;
+  case BRANCH_ACTIVITY:
+    // the random orders of the seed make restarts explore different tours
+    branch(*this, D_Order,     INT_VAR_ACTIVITY_SIZE_MAX(opt.decay()), INT_VAL_RND(Rnd(opt.seed())));
+    branch(*this, D_Station,   INT_VAR_ACTIVITY_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_tUnload,   INT_VAR_ACTIVITY_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_tLoad,     INT_VAR_NONE(), INT_VAL_RANGE_MAX());
+    break;
+  case BRANCH_SGS:
+    serialSchedule(*this, Deliveries, D_Order, D_Station, D_tLoad, D_tUnload,
+                   IntArgs(numV, V_first), IntArgs(numV, V_numD),
+                   O_tStart, O_dT_setup, S_tLoad, O_dt_travelTo);
+    break;
+  default:
+    break;
   }
+  
+  branch(*this, O_Lateness,  INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, O_tLag,      INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, D_Order,     INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, O_Poured,    INT_VAR_NONE(), INT_VAL_MIN());    
+  branch(*this, O_Preferred, INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, D_Station,   INT_VAR_NONE(), INT_VAL_MIN());
+  
+  branch(*this, D_tUnload,   INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, D_tLoad,     INT_VAR_NONE(), INT_VAL_RANGE_MAX());
+}
 
-  virtual ~RMC() {}
+RMC::RMC(bool share, RMC &rmc) 
+: RMCScript(share, rmc) 
+{
+  Deliveries.update(*this, share, rmc.Deliveries);
+  D_Order.update(*this, share, rmc.D_Order);
+  D_Station.update(*this, share, rmc.D_Station);
+  D_tLoad.update(*this, share, rmc.D_tLoad);
+  D_tUnload.update(*this, share, rmc.D_tUnload);
+  Cost.update(*this, share, rmc.Cost);
+  O_Poured.update(*this, share, rmc.O_Poured);
+  O_Deliveries.update(*this, share, rmc.O_Deliveries);
+  O_Waste.update(*this, share, rmc.O_Waste);
+  O_Lateness.update(*this, share, rmc.O_Lateness);
+  
+  O_tLag.update(*this, share, rmc.O_tLag);
+  O_Preferred.update(*this, share, rmc.O_Preferred);
+  
+  Input = rmc.Input;
+  SolutionFile = rmc.SolutionFile;
+}
 
-  /// copy support
-  
-  RMC(bool share, RMC &rmc) 
-  : MinimizeScript(share, rmc) 
-  {
-    Deliveries.update(*this, share, rmc.Deliveries);
-    D_Order.update(*this, share, rmc.D_Order);
-    D_Station.update(*this, share, rmc.D_Station);
-    D_tLoad.update(*this, share, rmc.D_tLoad);
-    D_tUnload.update(*this, share, rmc.D_tUnload);
-    Cost.update(*this, share, rmc.Cost);
-    O_Poured.update(*this, share, rmc.O_Poured);
-    O_Deliveries.update(*this, share, rmc.O_Deliveries);
-    O_Waste.update(*this, share, rmc.O_Waste);
-    O_Lateness.update(*this, share, rmc.O_Lateness);
-    
-    ODMap.update(*this, share, rmc.ODMap);
-    O_tLag.update(*this, share, rmc.O_tLag);
-    O_tUnload.update(*this, share, rmc.O_tUnload);
-    O_Preferred.update(*this, share, rmc.O_Preferred);
+RMCScript *RMCScript::create(const RMCOptions &opt)
+{
+  if (opt.model() == MODEL_ORDERS) {
+    return new RMCOrders(opt);
   }
+  return new RMC(opt);
+}
 
-  virtual Space* copy(bool share) {
-    return new RMC(share, *this);
+void RMCScript::postCostBounds(const RMCInput &input, IntVar cost, const IntVarArgs &poured, const IntVarArgs &waste,
+                               const IntVarArgs &lateness, const IntVarArgs &lag, const BoolVarArgs &preferred,
+                               const IntVarArgs &travelTo, const IntVarArgs &travelFrom, const IntVarArgs &deliveries)
+{
+  int numO = input.getNumOrders();
+  
+  // Every delivery pays at most the longest trips and a station that is not preferred
+  long long maxCost = (long long) preferred.size() * input.getAlpha3() +
+                      (long long) (travelTo.size() + travelFrom.size()) * input.getMaxTravelTime() * input.getAlpha5();
+  
+  for (int i = 0; i < numO; i++) {
+    const Order &o = input.getOrder(i);
+    
+    // All deliveries unload between the start of the order and its deadline, so lateness and
+    // time lags are limited by that window
+    int window = std::max(0, input.getOrderDeadlines()[i] - o.timeStart());
+    int maxPoured = (int) std::min<long long>(input.getMaxPoured(i), Int::Limits::max);
+    int maxWaste = std::max(0, maxPoured - o.totalVolume());
+    
+    rel(*this, lateness[i] >= input.getMinLateness(i));
+    rel(*this, lateness[i] <= window);
+    rel(*this, lag[i] <= window);
+    rel(*this, poured[i] <= maxPoured);
+    rel(*this, waste[i] <= maxWaste);
+    
+    maxCost += (long long) window * (input.getAlpha1() + input.getAlpha4()) + (long long) maxWaste * input.getAlpha2();
   }
+  rel(*this, cost <= (int) std::min<long long>(maxCost, Int::Limits::max));
   
-  /// optimisation
+  // Every delivery of an order travels at least the shortest trip to its yard
+  IntVarArgs terms;
+  IntArgs weights;
+  for (int i = 0; i < numO; i++) {
+    terms << lateness[i] << waste[i] << lag[i];
+    weights << input.getAlpha1() << input.getAlpha2() << input.getAlpha4();
+  }
+  terms << expr(*this, sum(preferred));
+  weights << input.getAlpha3();
+  for (int d = 0; d < travelFrom.size(); d++) {
+    terms << travelFrom[d];
+    weights << input.getAlpha5();
+  }
   
-  virtual IntVar cost(void) const {
-    return Cost;
+  IntArgs minTravel(numO);
+  for (int i = 0; i < numO; i++) {
+    minTravel[i] = input.getMinTravelTimeTo(i);
   }
   
-  /// printing 
+  costLowerBound(*this, cost, terms, weights, travelTo, deliveries, minTravel, input.getAlpha5());
+}
+
+void RMC::fixSchedule(const Schedule &schedule)
+{
+  int numV = Input->getNumVehicles();
+  const int *V_first = Input->getVehicleDeliveryOffsets();
+  const int *V_numD = Input->getVehicleMaxDeliveries();
   
-  void print(std::ostream &out) const {
-    // TODO print out per vehicle, skip unused deliveries
-    out << "Orders per delivery:\n";
-    out << D_Order << std::endl;
-    out << "Stations per delivery:\n";
-    out << D_Station << std::endl;
-    out << "Load Times:\n";
-    out << D_tLoad << std::endl;
-    out << "Unload Times:\n";
-    out << D_tUnload << std::endl;
+  std::vector<ScheduledDelivery> deliveries;
+  for (int i = 0; i < numV; i++) {
+    schedule.getVehicleDeliveries(i, deliveries);
     
-    out << "ODMap:\n";
-    out << ODMap << std::endl;
-    out << "O_tUnload:\n";
-    out << O_tUnload << std::endl;
-    out << "O_Preferred:\n";
-    out << O_Preferred << std::endl;
-    out << "O_tLag:\n";
-    out << O_tLag << std::endl;
-    out << std::endl;
+    int num = std::min((int)deliveries.size(), V_numD[i]);
+    rel(*this, Deliveries[i] >= num);
     
-    out << "Number of deliveries per order:\n";
-    out << O_Deliveries << std::endl;
-    out << "Number of deliveries per vehicle:\n";
-    out << Deliveries << std::endl;
-    out << "Concrete poured per order:\n";
-    out << O_Poured << std::endl;
-    out << "Waste per order:\n";
-    out << O_Waste << std::endl;
-    out << "Lateness per order:\n";
-    out << O_Lateness << std::endl;
-    out << "Cost: " << Cost << std::endl;
+    for (int d = 0; d < num; d++) {
+      rel(*this, D_Order[V_first[i] + d] == deliveries[d].order);
+      rel(*this, D_Station[V_first[i] + d] == deliveries[d].station);
+    }
+  }
+}
+
+void RMC::relax(const Schedule &schedule, const Relaxation &relaxation)
+{
+  int numV = Input->getNumVehicles();
+  const int *V_first = Input->getVehicleDeliveryOffsets();
+  const int *V_numD = Input->getVehicleMaxDeliveries();
+  
+  // vehicles with a relaxed delivery, their other deliveries may move in time
+  const std::vector<ScheduledDelivery> &deliveries = schedule.getDeliveries();
+  std::vector<bool> touched(numV, false);
+  for (size_t j = 0; j < deliveries.size(); j++) {
+    if (relaxation.deliveries[j]) touched[deliveries[j].vehicle] = true;
+  }
+  
+  // deliveries of a vehicle are listed in tour order, so they keep their slots
+  std::vector<int> numD(numV, 0);
+  std::vector<int> lastFixed(numV, -1);
+  for (size_t j = 0; j < deliveries.size(); j++) {
+    const ScheduledDelivery &del = deliveries[j];
+    int d = numD[del.vehicle]++;
+    if (d >= V_numD[del.vehicle] || relaxation.deliveries[j] || relaxation.vehicles[del.vehicle]) continue;
+    
+    int k = V_first[del.vehicle] + d;
+    rel(*this, D_Order[k],   IRT_EQ, del.order);
+    rel(*this, D_Station[k], IRT_EQ, del.station);
+    if (!touched[del.vehicle]) {
+      rel(*this, D_tLoad[k],   IRT_EQ, del.tLoad);
+      rel(*this, D_tUnload[k], IRT_EQ, del.tUnload);
+    }
+    lastFixed[del.vehicle] = d;
+  }
+  
+  // relaxed deliveries after the last fixed one may be dropped, and the tour may grow
+  for (int i = 0; i < numV; i++) {
+    if (relaxation.vehicles[i] || touched[i]) {
+      rel(*this, Deliveries[i], IRT_GQ, lastFixed[i] + 1);
+    } else {
+      rel(*this, Deliveries[i], IRT_EQ, std::min(numD[i], V_numD[i]));
+    }
   }
+}
 
-};
+void RMC::getSchedule(Schedule &schedule) const
+{
+  int numV = Input->getNumVehicles();
+  const int *V_first = Input->getVehicleDeliveryOffsets();
+  
+  schedule.clear();
+  
+  for (int i = 0; i < numV; i++) {
+    for (int d = 0; d < Deliveries[i].val(); d++) {
+      int idx = V_first[i] + d;
+      schedule.addDelivery(i, D_Order[idx].val(), D_Station[idx].val(), D_tLoad[idx].val(), D_tUnload[idx].val());
+    }
+  }
+  schedule.setCost(Cost.val());
+}
+
+void RMC::print(std::ostream &out) const {
+  if (SolutionFile) {
+    Schedule schedule;
+    getSchedule(schedule);
+    schedule.write(SolutionFile, *Input);
+  }
+  
+  // TODO print out per vehicle, skip unused deliveries
+  out << "Orders per delivery:\n";
+  out << D_Order << std::endl;
+  out << "Stations per delivery:\n";
+  out << D_Station << std::endl;
+  out << "Load Times:\n";
+  out << D_tLoad << std::endl;
+  out << "Unload Times:\n";
+  out << D_tUnload << std::endl;
+  
+  out << "O_Preferred:\n";
+  out << O_Preferred << std::endl;
+  out << "O_tLag:\n";
+  out << O_tLag << std::endl;
+  out << std::endl;
+  
+  out << "Number of deliveries per order:\n";
+  out << O_Deliveries << std::endl;
+  out << "Number of deliveries per vehicle:\n";
+  out << Deliveries << std::endl;
+  out << "Concrete poured per order:\n";
+  out << O_Poured << std::endl;
+  out << "Waste per order:\n";
+  out << O_Waste << std::endl;
+  out << "Lateness per order:\n";
+  out << O_Lateness << std::endl;
+  out << "Cost: " << Cost << std::endl;
+}
+
+/**
+ * Solve the instance on a time grid that is granularity times coarser, within COARSE_TIME_SHARE
+ * of the time limit of the options. The best schedule is scaled back to the resolution of the instance, returns false
+ * if no schedule was found.
+ */
+static bool solveCoarse(const RMCOptions &fineOpt, int granularity, Schedule &schedule)
+{
+  RMCInput input;
+  if (!input.coarsen(fineOpt.getInput(), granularity)) {
+    return false;
+  }
+  
+  RMCOptions opt(fineOpt.name(), input);
+  opt.copySettings(fineOpt);
+  if (fineOpt.heuristic() != HEURISTIC_NONE && input.getHeuristicCost() >= 0) {
+    opt.setCostBound(input.getHeuristicCost());
+  }
+  
+  RMCScript *root = RMCScript::create(opt);
+  
+  Search::Options so;
+  so.threads = fineOpt.threads();
+  unsigned long time = static_cast<unsigned long>(fineOpt.time() * COARSE_TIME_SHARE);
+  Search::TimeStop *stop = fineOpt.time() > 0 ? new Search::TimeStop(std::max(1UL, time)) : NULL;
+  so.stop = stop;
+  
+  Search::Statistics stat;
+  bool stopped;
+  RMCScript *best = searchBest(root, opt, so, stat, stopped);
+  delete stop;
+  
+  if (!best) {
+    return false;
+  }
+  
+  Schedule coarse;
+  best->getSchedule(coarse);
+  delete best;
+  
+  std::cout << "Coarse solution (" << granularity << " time units per step): cost " << coarse.getCost()
+            << (stopped ? "" : ", optimal") << std::endl;
+  
+  // the coarse durations are rounded up, so the scaled times keep all constraints
+  int scale = input.getTimeScale() / fineOpt.getInput().getTimeScale();
+  const std::vector<ScheduledDelivery> &deliveries = coarse.getDeliveries();
+  schedule.clear();
+  for (size_t i = 0; i < deliveries.size(); i++) {
+    const ScheduledDelivery &d = deliveries[i];
+    schedule.addDelivery(d.vehicle, d.order, d.station, d.tLoad * scale, d.tUnload * scale);
+  }
+  schedule.setCost(schedule.computeCost(fineOpt.getInput()));
+  
+  return true;
+}
 
 int main(int argc, char** argv) {
   
@@ -526,8 +711,33 @@ int main(int argc, char** argv) {
   RMCOptions opt("RMC", input);
   opt.iterations(0);
   opt.solutions(0);
+  // all cores, unless given with -threads
+  opt.threads(0);
   opt.parse(argc,argv);
-  opt.loadProblem();
+  
+  // the deterministic search checks the time limit only between waves of subtrees
+  if (opt.deterministic() && opt.time() > 0 && opt.fail() == 0) {
+    std::cerr << "error: -deterministic with -time also needs -fail to bound every subtree\n";
+    return 1;
+  }
+  
+  ReadXML::initParser();
+  
+  if (opt.batch()) {
+    int ret = runBatch(opt);
+    ReadXML::cleanupParser();
+    return ret;
+  }
+  
+  bool loaded = opt.loadProblem();
+  ReadXML::cleanupParser();
+  if (!loaded) {
+    return 1;
+  }
+  
+  if (opt.compileTo()) {
+    return opt.getInput().saveCompiled(opt.compileTo()) ? 0 : 1;
+  }
   
   for (int i = 0; i < opt.getInput().getNumOrders(); i++) {
     if (opt.getInput().getMinDeliveries(i) == -1) {
@@ -536,7 +746,108 @@ int main(int argc, char** argv) {
     }
   }
   
-  MinimizeScript::run<RMC,BAB,RMCOptions>(opt);
+  std::cout << "Horizon: " << opt.getInput().getMaxTimeStamp()
+            << " (additive bound " << opt.getInput().getAdditiveTimeStamp() << ")\n";
+  
+  // Solve independent parts separately, unless we have to follow a previous schedule
+  std::vector<Component> components;
+  if (opt.decompose() && !opt.warmStartFile() && opt.granularity() <= 1) {
+    findComponents(opt.getInput(), components);
+  }
+  if (components.size() > 1) {
+    std::cout << "Components: " << components.size() << std::endl;
+    if (solveComponents(opt, components)) {
+      return 0;
+    }
+    std::cout << "Decomposition failed, solving the whole instance" << std::endl;
+  }
+  
+  // Start from a previous schedule, or from a solution on a coarser time grid
+  Schedule warmStart;
+  bool haveWarmStart = false;
+  if (opt.warmStartFile()) {
+    if (!warmStart.read(opt.warmStartFile(), opt.getInput())) {
+      return 1;
+    }
+    haveWarmStart = true;
+  } else if (opt.granularity() > 1) {
+    Support::Timer timer;
+    timer.start();
+    haveWarmStart = solveCoarse(opt, opt.granularity(), warmStart);
+    if (!haveWarmStart) {
+      std::cout << "Coarse time grid: no solution found" << std::endl;
+    }
+    
+    // the fine search gets what is left of the time limit
+    if (opt.time() > 0) {
+      unsigned int used = static_cast<unsigned int>(timer.stop());
+      opt.time(used < opt.time() ? opt.time() - used : 1);
+    }
+  }
+  
+  if (haveWarmStart) {
+    warmStart.sortEquivalentVehicles(opt.getInput());
+    opt.setWarmStart(&warmStart);
+    
+    // Complete the previous assignment on the new instance to get an initial bound
+    RMCScript *probe = RMCScript::create(opt);
+    probe->fixSchedule(warmStart);
+    
+    Search::Options so;
+    Search::FailStop stop(WARMSTART_FAIL_LIMIT);
+    so.stop = &stop;
+    
+    DFS<RMCScript> e(probe, so);
+    delete probe;
+    
+    if (RMCScript *s = e.next()) {
+      std::cout << "Warm start bound: " << s->cost() << std::endl;
+      opt.setCostBound(s->cost().val());
+      delete s;
+    } else {
+      std::cout << "Warm start: no solution found close to the previous schedule" << std::endl;
+    }
+  }
+  
+  // Bound the cost by the list schedule, unless the warm start is already better
+  int heuristicCost = opt.getInput().getHeuristicCost();
+  if (opt.heuristic() != HEURISTIC_NONE && heuristicCost >= 0 &&
+      (opt.getCostBound() < 0 || heuristicCost < opt.getCostBound())) {
+    if (opt.heuristic() == HEURISTIC_PRINT) {
+      ListScheduler scheduler(opt.getInput());
+      Schedule heuristic;
+      scheduler.run(heuristic);
+      
+      std::cout << "Heuristic solution:\n";
+      heuristic.print(std::cout, opt.getInput());
+      std::cout << std::endl;
+      if (opt.solutionFile()) {
+        heuristic.write(opt.solutionFile(), opt.getInput());
+      }
+      
+      if (heuristicCost == 0) {
+        return 0;
+      }
+      // only search for cheaper solutions
+      opt.setCostBound(heuristicCost - 1);
+    } else {
+      std::cout << "Heuristic bound: " << heuristicCost << std::endl;
+      opt.setCostBound(heuristicCost);
+    }
+  }
+  
+  // the driver is kept for Gist and the time and statistics modes
+  if (opt.mode() == SM_SOLUTION && opt.portfolio()) {
+    solvePortfolio(opt);
+  } else if (opt.mode() == SM_SOLUTION && opt.lns()) {
+    solveLNS(opt);
+  } else if (opt.mode() == SM_SOLUTION) {
+    solveParallel(opt);
+  } else if (opt.model() == MODEL_ORDERS) {
+    MinimizeScript::run<RMCOrders,BAB,RMCOptions>(opt);
+  } else {
+    MinimizeScript::run<RMC,BAB,RMCOptions>(opt);
+  }
   
   return 0;
 }
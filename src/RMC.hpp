@@ -0,0 +1,299 @@
+/*
+ * RMC.hpp
+ *
+ *  Created on: Mar 17, 2014
+ *  Author: stefan
+ */
+
+#ifndef RMC_HPP_
+#define RMC_HPP_
+
+#include "Problem.hpp"
+#include "Schedule.hpp"
+
+#include <gecode/int.hh>
+#include <gecode/minimodel.hh>
+#include <gecode/driver.hh>
+
+#include <iostream>
+#include <vector>
+
+using namespace Gecode;
+
+/// Use of the list schedule before search
+enum {
+  HEURISTIC_NONE,   ///< search without an initial bound
+  HEURISTIC_BOUND,  ///< bound the cost by the list schedule
+  HEURISTIC_PRINT   ///< print the list schedule as first solution, search for better ones only
+};
+
+/// Formulation of the model
+enum {
+  MODEL_VEHICLES,   ///< delivery slots per vehicle (D_v), class RMC
+  MODEL_ORDERS      ///< delivery slots per order (D_o), class RMCOrders
+};
+
+/// Branching strategy, the portfolio runs all of them
+enum {
+  BRANCH_STATIC,      ///< delivery counts, per order results, then the tours in slot order
+  BRANCH_TOURS,       ///< complete the tours before the per order results
+  BRANCH_FIRST_FAIL,  ///< tours with the smallest domains and earliest times first
+  BRANCH_AFC,         ///< tours with the most failures per domain size first
+  BRANCH_ACTIVITY,    ///< tours with the highest activity per domain size first, random vehicle or order
+  BRANCH_SGS,         ///< tours built in time order, the vehicle that is free first gets its next delivery
+  BRANCH_NUM
+};
+
+static const char *const BRANCH_NAMES[BRANCH_NUM] = { "static", "tours", "firstfail", "afc", "activity", "sgs" };
+
+class RMCOptions : public InstanceOptions {
+private:
+  RMCInput &Input;
+  
+  Driver::StringValueOption _compile;
+  Driver::StringValueOption _batch;
+  Driver::UnsignedIntOption _workers;
+  Driver::StringValueOption _warmStartFile;
+  Driver::StringValueOption _solutionFile;
+  Driver::StringOption      _heuristic;
+  Driver::BoolOption        _decompose;
+  Driver::UnsignedIntOption _granularity;
+  Driver::BoolOption        _deterministic;
+  Driver::BoolOption        _portfolio;
+  Driver::BoolOption        _lns;
+  Driver::UnsignedIntOption _lnsFail;
+  
+  const Schedule *_warmStart;
+  int _costBound;
+public:
+  RMCOptions(const char *name, RMCInput &input) 
+  : InstanceOptions(name), Input(input),
+    _compile("-compile", "write the instance as compiled instance file and exit"),
+    _batch("-batch", "solve all instances matching a glob pattern, or listed in @file"),
+    _workers("-workers", "number of instances or components solved concurrently (0 = all cores)", 0),
+    _warmStartFile("-warmstart", "schedule file of a previous solution to start the search from"),
+    _solutionFile("-solution", "write the schedule of every solution found to this file"),
+    _heuristic("-heuristic", "use a list schedule to bound the cost before search", HEURISTIC_BOUND),
+    _decompose("-decompose", "solve independent parts of the instance separately", true),
+    _granularity("-granularity", "solve on a time grid this many times coarser first and refine the solution (1 = off)", 1),
+    _deterministic("-deterministic", "split the search into fixed subtrees so that parallel runs are reproducible (-time needs -fail)", false),
+    _portfolio("-portfolio", "run all branching strategies concurrently, sharing the best cost", false),
+    _lns("-lns", "improve a first solution by large neighbourhood search until the time limit (default 60 s)", false),
+    _lnsFail("-lnsfail", "fail limit for every neighbourhood searched by LNS", 1000),
+    _warmStart(0), _costBound(-1)
+  {
+    _heuristic.add(HEURISTIC_NONE, "none");
+    _heuristic.add(HEURISTIC_BOUND, "bound", "post its cost as upper bound");
+    _heuristic.add(HEURISTIC_PRINT, "print", "print it as first solution, search for cheaper ones");
+    
+    model(MODEL_VEHICLES, "vehicles", "delivery slots per vehicle");
+    model(MODEL_ORDERS, "orders", "delivery slots per order");
+    model(MODEL_VEHICLES);
+    
+    branching(BRANCH_STATIC, BRANCH_NAMES[BRANCH_STATIC], "delivery counts and per order results first");
+    branching(BRANCH_TOURS, BRANCH_NAMES[BRANCH_TOURS], "complete the tours first");
+    branching(BRANCH_FIRST_FAIL, BRANCH_NAMES[BRANCH_FIRST_FAIL], "smallest domains and earliest times first");
+    branching(BRANCH_AFC, BRANCH_NAMES[BRANCH_AFC], "most failures per domain size first");
+    branching(BRANCH_ACTIVITY, BRANCH_NAMES[BRANCH_ACTIVITY], "highest activity per domain size first, for restarts");
+    branching(BRANCH_SGS, BRANCH_NAMES[BRANCH_SGS], "build the tours in time order");
+    branching(BRANCH_STATIC);
+    
+    add(_compile);
+    add(_batch);
+    add(_workers);
+    add(_warmStartFile);
+    add(_solutionFile);
+    add(_heuristic);
+    add(_decompose);
+    add(_granularity);
+    add(_deterministic);
+    add(_portfolio);
+    add(_lns);
+    add(_lnsFail);
+  }
+  
+  bool loadProblem() {
+    return Input.loadProblem(instance());
+  }
+  
+  /// Take the model and search settings of other options, to solve an instance derived from
+  /// theirs the same way. The instance, the cost bound and the warm start are not copied.
+  void copySettings(const RMCOptions &opt) {
+    model(opt.model());
+    branching(opt.branching());
+    icl(opt.icl());
+    decay(opt.decay());
+    seed(opt.seed());
+    threads(opt.threads());
+    c_d(opt.c_d());
+    a_d(opt.a_d());
+    node(opt.node());
+    fail(opt.fail());
+    time(opt.time());
+    restart(opt.restart());
+    restart_base(opt.restart_base());
+    restart_scale(opt.restart_scale());
+    nogoods(opt.nogoods());
+    nogoods_limit(opt.nogoods_limit());
+  }
+  
+  const RMCInput &getInput() const { return Input; }
+  
+  /// Compiled instance file to write, or NULL
+  const char *compileTo() const { return _compile.value(); }
+  
+  /// Instance pattern for batch mode, or NULL
+  const char *batch() const { return _batch.value(); }
+  
+  unsigned int workers() const { return _workers.value(); }
+  
+  const char *warmStartFile() const { return _warmStartFile.value(); }
+  
+  const char *solutionFile() const { return _solutionFile.value(); }
+  
+  int heuristic() const { return _heuristic.value(); }
+  
+  bool decompose() const { return _decompose.value(); }
+  
+  unsigned int granularity() const { return _granularity.value(); }
+  
+  bool deterministic() const { return _deterministic.value(); }
+  
+  bool portfolio() const { return _portfolio.value(); }
+  
+  bool lns() const { return _lns.value(); }
+  
+  unsigned int lnsFail() const { return _lnsFail.value(); }
+  
+  /// Schedule to try first during search, or NULL
+  const Schedule *getWarmStart() const { return _warmStart; }
+  
+  void setWarmStart(const Schedule *schedule) { _warmStart = schedule; }
+  
+  /// Upper bound for the cost, or -1 if there is none
+  int getCostBound() const { return _costBound; }
+  
+  void setCostBound(int bound) { _costBound = bound; }
+};
+
+/// Part of a schedule that is solved again by LNS, everything else stays fixed
+struct Relaxation {
+  /// Per delivery of the schedule, true if vehicle, order, station and times may change. The other
+  /// deliveries of its vehicle keep vehicle, order and station, but may move in time.
+  std::vector<bool> deliveries;
+  /// Per vehicle, true if the vehicle may serve other deliveries, all of its deliveries are relaxed
+  std::vector<bool> vehicles;
+};
+
+/// Common interface of the model formulations
+class RMCScript : public MinimizeScript {
+public:
+  RMCScript() {}
+  
+  RMCScript(bool share, RMCScript &s) : MinimizeScript(share, s) {}
+  
+  /// Restrict orders and stations of all vehicles to the given schedule
+  virtual void fixSchedule(const Schedule &schedule) = 0;
+  
+  /// Get the schedule of a solution
+  virtual void getSchedule(Schedule &schedule) const = 0;
+  
+  /// Fix all deliveries of the schedule that are not relaxed to their slot, vehicle, order,
+  /// station and times
+  virtual void relax(const Schedule &schedule, const Relaxation &relaxation) = 0;
+  
+  /// Create the model selected by opt.model()
+  static RMCScript *create(const RMCOptions &opt);
+  
+protected:
+  /// Post finite upper bounds of the cost and its components per order, and a lower bound of the
+  /// cost from what every order costs at least
+  void postCostBounds(const RMCInput &input, IntVar cost, const IntVarArgs &poured, const IntVarArgs &waste,
+                      const IntVarArgs &lateness, const IntVarArgs &lag, const BoolVarArgs &preferred,
+                      const IntVarArgs &travelTo, const IntVarArgs &travelFrom, const IntVarArgs &deliveries);
+};
+
+class RMC : public RMCScript {
+  
+protected:
+  
+  // ------------- Decision Variables ----------------
+  
+  // Number of deliveries per vehicle
+  IntVarArray Deliveries;
+  
+  // Order number per delivery (i * numV + d)
+  IntVarArray D_Order;
+  
+  // Index of start station
+  IntVarArray D_Station;
+  
+  // Timestamp when loading starts for delivery d
+  IntVarArray D_tLoad;
+  
+  // Timestamp when unloading starts for delivery d
+  IntVarArray D_tUnload;
+  
+  // --------------- Optimization Goal ---------------
+  
+  // Cost function value
+  IntVar Cost;
+  
+  // --------------- Result values -------------------
+  
+  // Total amount of concrete poured per order
+  IntVarArray O_Poured;
+
+  // Amount of deliveries per order
+  IntVarArray O_Deliveries;
+  
+  // Amount of waste per order
+  IntVarArray O_Waste;
+  
+  // Lateness of orders
+  IntVarArray O_Lateness;
+  
+  // Total time lag between the deliveries of orders
+  IntVarArray O_tLag;
+  BoolVarArray O_Preferred;
+  
+  // ---------------- Other data ---------------------
+  
+  // Input data, owned by the options, outlives all spaces
+  const RMCInput *Input;
+  
+  // File to write schedules to, or NULL
+  const char *SolutionFile;
+public:
+  /// problem construction
+  RMC(const RMCOptions &opt);
+
+  virtual ~RMC() {}
+
+  /// copy support
+  RMC(bool share, RMC &rmc);
+
+  virtual Space* copy(bool share) {
+    return new RMC(share, *this);
+  }
+  
+  /// optimisation
+  
+  virtual IntVar cost(void) const {
+    return Cost;
+  }
+  
+  virtual void fixSchedule(const Schedule &schedule);
+  
+  virtual void getSchedule(Schedule &schedule) const;
+  
+  virtual void relax(const Schedule &schedule, const Relaxation &relaxation);
+  
+  /// printing 
+  void print(std::ostream &out) const;
+};
+
+/// Solve all instances given by opt.batch() concurrently, using opt.time() as time budget per instance
+int runBatch(const RMCOptions &opt);
+
+#endif
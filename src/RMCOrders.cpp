@@ -0,0 +1,552 @@
+/*
+ * RMCOrders.cpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#include "RMCOrders.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+/// Sort deliveries of an order by unloading time
+struct UnloadLess {
+  bool operator()(const ScheduledDelivery &a, const ScheduledDelivery &b) const {
+    return a.tUnload < b.tUnload;
+  }
+};
+
+/// Sort indices of deliveries by unloading time
+struct IndexUnloadLess {
+  const std::vector<ScheduledDelivery> &deliveries;
+
+  IndexUnloadLess(const std::vector<ScheduledDelivery> &d) : deliveries(d) {}
+
+  bool operator()(int a, int b) const {
+    return deliveries[a].tUnload < deliveries[b].tUnload;
+  }
+};
+
+/// Sort deliveries by vehicle, and by loading time within the tour of a vehicle
+struct TourLess {
+  bool operator()(const ScheduledDelivery &a, const ScheduledDelivery &b) const {
+    return a.vehicle < b.vehicle || (a.vehicle == b.vehicle && a.tLoad < b.tLoad);
+  }
+};
+
+RMCOrders::RMCOrders(const RMCOptions &opt)
+: O_Deliveries(*this, opt.getInput().getNumOrders(), 1, opt.getInput().getMaxDeliveries()),
+  D_Vehicle(*this, opt.getInput().getMaxDeliveries(), 0, opt.getInput().getNumVehicles() - 1),
+  D_Station(*this, opt.getInput().getMaxDeliveries(), 0, opt.getInput().getNumStations() - 1),
+  D_tLoad(*this, opt.getInput().getMaxDeliveries(), 0, opt.getInput().getMaxTimeStamp()),
+  D_tUnload(*this, opt.getInput().getMaxDeliveries(), 0, opt.getInput().getMaxTimeStamp()),
+  D_Next(*this, opt.getInput().getMaxDeliveries(), 0, 2 * opt.getInput().getMaxDeliveries() - 1),
+  Cost(*this, 0, Int::Limits::max),
+  O_Poured(*this, opt.getInput().getNumOrders(), 1, Int::Limits::max),
+  O_Waste(*this, opt.getInput().getNumOrders(), 0, Int::Limits::max),
+  O_Lateness(*this, opt.getInput().getNumOrders(), 0, Int::Limits::max),
+  O_tLag(*this, opt.getInput().getNumOrders(), 0, Int::Limits::max),
+  O_Preferred(*this, opt.getInput().getMaxDeliveries(), 0, 1),
+  Input(&opt.getInput()), SolutionFile(opt.solutionFile())
+{
+  const RMCInput &input = opt.getInput();
+
+  int numV = input.getNumVehicles();
+  int numO = input.getNumOrders();
+  int numS = input.getNumStations();
+  // Delivery slots per order, the rows of the per delivery arrays have different lengths.
+  // Row o starts at O_first[o] and has O_numD[o] entries.
+  const int *O_first = input.getOrderDeliveryOffsets();
+  const int *O_numD = input.getOrderMaxDeliveries();
+  // Delivery slots of all orders
+  int numD = input.getMaxDeliveries();
+
+  const int *compatible = input.getOrderVehicleCompatible();
+
+  // Set boolean flags for all active deliveries
+  BoolVarArgs D_Used(*this, numD, 0, 1);
+
+  for (int i = 0; i < numO; i++) {
+    rel(*this, O_Deliveries[i] >= input.getMinDeliveries(i));
+    rel(*this, O_Deliveries[i] <= O_numD[i]);
+    for (int d = 0; d < O_numD[i]; d++) {
+      rel(*this, D_Used[O_first[i] + d] == (d < O_Deliveries[i]));
+    }
+  }
+
+  // Vehicles must be able to serve the order. Unused deliveries are set to the first of these
+  // vehicles, station 0 and time 0, and are not part of any tour.
+  for (int i = 0; i < numO; i++) {
+    IntArgs vehicles;
+    for (int v = 0; v < numV; v++) {
+      if (compatible[i * numV + v]) vehicles << v;
+    }
+    if (vehicles.size() == 0) {
+      fail();
+      return;
+    }
+
+    for (int d = 0; d < O_numD[i]; d++) {
+      int k = O_first[i] + d;
+      dom(*this, D_Vehicle[k], IntSet(vehicles));
+      rel(*this, D_Used[k] || (D_Vehicle[k] == vehicles[0]));
+      rel(*this, D_Used[k] || (D_Station[k] == 0));
+      rel(*this, D_Used[k] || (D_tLoad[k] == 0));
+      rel(*this, D_Used[k] || (D_tUnload[k] == 0));
+      rel(*this, D_Used[k] || (D_Next[k] == numD + k));
+    }
+  }
+
+  /// ----- helper variables per delivery -----
+
+  // Station load times
+  IntArgs S_tLoad(numS, input.getStationLoadTimes());
+
+  IntArgs V_available(numV, input.getVehicleAvailableFrom());
+
+  int maxVolume = 0;
+  for (int k = 0; k < numO * numV; k++) {
+    maxVolume = std::max(maxVolume, input.getOrderVehicleVolumes()[k]);
+  }
+
+  IntVarArgs D_delivered(*this, numD, 0, maxVolume);
+  IntVarArgs D_poured(*this, numD, 0, maxVolume);
+  IntVarArgs D_dT_Unloading(*this, numD, 0, input.getMaxUnloadingTime());
+  IntVarArgs D_dT_travelTo(*this, numD, 0, input.getMaxTravelTime());
+  IntVarArgs D_dT_travelFrom(*this, numD, 0, input.getMaxTravelTime());
+
+  for (int i = 0; i < numO; i++) {
+    const Order &o = input.getOrder(i);
+
+    // Volume and unloading time per vehicle, travel times per station
+    IntArgs volumes(numV);
+    IntArgs unloading(numV);
+    for (int v = 0; v < numV; v++) {
+      volumes[v] = input.getOrderVehicleVolumes()[i * numV + v];
+      unloading[v] = input.getUnloadingTime(i, v);
+    }
+    IntArgs travelTo(numS);
+    for (int s = 0; s < numS; s++) {
+      travelTo[s] = input.getTravelTimeTo(i, s);
+    }
+
+    IntVarArgs poured;
+    IntVarArgs lags;
+
+    for (int d = 0; d < O_numD[i]; d++) {
+      int k = O_first[i] + d;
+
+      rel(*this, (D_delivered[k] == element(volumes, D_Vehicle[k]) && D_Used[k]) ||
+                 (D_delivered[k] == 0 && !D_Used[k]));
+      rel(*this, (D_dT_Unloading[k] == element(unloading, D_Vehicle[k]) && D_Used[k]) ||
+                 (D_dT_Unloading[k] == 0 && !D_Used[k]));
+      rel(*this, D_poured[k] == min(D_delivered[k],
+                                    (input.getTimeMax() - D_tUnload[k] + D_tLoad[k]) * o.dischargeRate()));
+      poured << D_poured[k];
+
+      rel(*this, (D_dT_travelTo[k] == element(travelTo, D_Station[k]) && D_Used[k]) ||
+                 (D_dT_travelTo[k] == 0 && !D_Used[k]));
+
+      // Unloading after the vehicle arrived at the yard, not before the order starts, nor after
+      // its deadline. Loading not before the vehicle is available.
+      rel(*this, D_tLoad[k] + element(S_tLoad, D_Station[k]) + D_dT_travelTo[k] + o.dTimeSetup() <= D_tUnload[k] ||
+                 !D_Used[k]);
+      rel(*this, D_tUnload[k] >= o.timeStart() || !D_Used[k]);
+      rel(*this, D_tUnload[k] <= input.getOrderDeadlines()[i] || !D_Used[k]);
+      rel(*this, D_tLoad[k] >= element(V_available, D_Vehicle[k]) || !D_Used[k]);
+
+      rel(*this, O_Preferred[k] == (D_Station[k] != o.preferredStation() && D_Used[k]));
+
+      // Deliveries are sorted by unloading time, the time lag is the time between the end of
+      // the previous unloading and the start of this one
+      if (d > 0) {
+        IntVar lag(*this, 0, input.getMaxTimeStamp());
+        rel(*this, (lag == D_tUnload[k] - D_tUnload[k-1] - D_dT_Unloading[k-1] && D_Used[k]) ||
+                   (lag == 0 && !D_Used[k]));
+        lags << lag;
+      }
+    }
+
+    rel(*this, O_Poured[i] == sum(poured));
+    rel(*this, O_Poured[i] >= o.totalVolume());
+    rel(*this, O_Waste[i] == O_Poured[i] - o.totalVolume());
+
+    rel(*this, O_Lateness[i] == D_tUnload[O_first[i]] - o.timeStart());
+    if (lags.size() > 0) {
+      rel(*this, O_tLag[i] == sum(lags));
+    } else {
+      rel(*this, O_tLag[i] == 0);
+    }
+  }
+
+  /// ---- tours of the vehicles ----
+
+  // Successors can only be deliveries of orders that share a vehicle, or the end of the tour
+  for (int i = 0; i < numO; i++) {
+    for (int d = 0; d < O_numD[i]; d++) {
+      int k = O_first[i] + d;
+
+      IntArgs next;
+      for (int j = 0; j < numO; j++) {
+        bool shared = false;
+        for (int v = 0; v < numV && !shared; v++) {
+          shared = compatible[i * numV + v] && compatible[j * numV + v];
+        }
+        if (!shared) continue;
+
+        for (int e = 0; e < O_numD[j]; e++) {
+          if (O_first[j] + e != k) next << O_first[j] + e;
+        }
+      }
+      next << numD + k;
+      dom(*this, D_Next[k], IntSet(next));
+    }
+  }
+  distinct(*this, D_Next);
+
+  // Values of the successor, indices numD and above stand for the end of a tour
+  IntVar zero(*this, 0, 0);
+  IntVarArgs nextVehicle(D_Vehicle);
+  IntVarArgs nextStation(D_Station);
+  IntVarArgs nextLoad(D_tLoad);
+  for (int k = 0; k < numD; k++) {
+    nextVehicle << zero;
+    nextStation << zero;
+    nextLoad << zero;
+  }
+
+  // Vehicle of the first delivery of every tour, numV + d if d is not the first delivery
+  IntVarArgs firstVehicle(*this, numD, 0, numV + numD - 1);
+
+  for (int i = 0; i < numO; i++) {
+    IntArgs travelFrom(numS);
+    for (int s = 0; s < numS; s++) {
+      travelFrom[s] = input.getTravelTimeFrom(i, s);
+    }
+
+    for (int d = 0; d < O_numD[i]; d++) {
+      int k = O_first[i] + d;
+
+      BoolVar hasNext(*this, 0, 1);
+      rel(*this, hasNext == (D_Next[k] < numD));
+
+      // The next delivery uses the same vehicle and is loaded after the vehicle travelled back
+      IntVar station = expr(*this, element(nextStation, D_Next[k]));
+      IntVar load = expr(*this, element(nextLoad, D_Next[k]));
+      rel(*this, (D_dT_travelFrom[k] == element(travelFrom, station) && hasNext) ||
+                 (D_dT_travelFrom[k] == 0 && !hasNext));
+      rel(*this, element(nextVehicle, D_Next[k]) == D_Vehicle[k] || !hasNext);
+      rel(*this, D_tUnload[k] + D_dT_Unloading[k] + D_dT_travelFrom[k] <= load || !hasNext);
+      rel(*this, D_tLoad[k] < load || !hasNext);
+
+      // Only used deliveries have a predecessor. Deliveries without one start a tour at
+      // station 0, every vehicle has at most one tour.
+      IntVar predecessors(*this, 0, 1);
+      count(*this, D_Next, k, IRT_EQ, predecessors);
+      rel(*this, D_Used[k] || predecessors == 0);
+
+      BoolVar first(*this, 0, 1);
+      rel(*this, first == (D_Used[k] && predecessors == 0));
+      rel(*this, D_Station[k] == 0 || !first);
+      rel(*this, (firstVehicle[k] == D_Vehicle[k] && first) || (firstVehicle[k] == numV + k && !first));
+    }
+  }
+  distinct(*this, firstVehicle);
+
+  /// ---- add constraints ----
+
+  // Only one vehicle can be loaded at a station at a time
+  for (int i = 0; i < numS; i++) {
+    const Station &s = input.getStation(i);
+
+    // True for every delivery loaded at station i
+    BoolVarArgs AtStation(*this, numD, 0, 1);
+    IntArgs LoadTime = IntArgs::create(numD, s.loadingMinutes(), 0);
+
+    for (int d = 0; d < numD; d++) {
+      rel(*this, AtStation[d] == (D_Station[d] == i && D_Used[d]));
+    }
+
+    unary(*this, D_tLoad, LoadTime, AtStation);
+  }
+
+  // Only one vehicle can be unloaded at a construction yard at a time. The yard of every
+  // delivery is known from its order.
+  for (int y = 0; y < input.getNumYards(); y++) {
+    IntVarArgs start, duration, end;
+    BoolVarArgs AtYard;
+
+    for (int i = 0; i < numO; i++) {
+      if (input.getOrderYards()[i] != y) continue;
+
+      for (int d = 0; d < O_numD[i]; d++) {
+        int k = O_first[i] + d;
+        start << D_tUnload[k];
+        duration << D_dT_Unloading[k];
+        end << expr(*this, D_tUnload[k] + D_dT_Unloading[k]);
+        AtYard << D_Used[k];
+      }
+    }
+
+    if (start.size() > 1) {
+      unary(*this, start, duration, end, AtYard);
+    }
+  }
+
+  // Total costs
+  rel(*this, Cost == sum(O_Lateness) * input.getAlpha1() + sum(O_Waste) * input.getAlpha2() +
+                     sum(O_Preferred) * input.getAlpha3() + sum(O_tLag) * input.getAlpha4() +
+                     (sum(D_dT_travelTo) + sum(D_dT_travelFrom)) * input.getAlpha5());
+
+  postCostBounds(input, Cost, O_Poured, O_Waste, O_Lateness, O_tLag, O_Preferred,
+                 D_dT_travelTo, D_dT_travelFrom, O_Deliveries);
+
+  if (opt.getCostBound() >= 0) {
+    rel(*this, Cost <= opt.getCostBound());
+  }
+
+  /// ----------- branching -----------
+
+  // Try the assignment of the warm start schedule first
+  if (opt.getWarmStart()) {
+    IntArgs wsDeliveries = IntArgs::create(numO, 0, 0);
+    IntArgs wsVehicle    = IntArgs::create(numD, 0, 0);
+    IntArgs wsStation    = IntArgs::create(numD, 0, 0);
+    IntArgs wsLoad       = IntArgs::create(numD, 0, 0);
+    IntArgs wsUnload     = IntArgs::create(numD, 0, 0);
+
+    std::vector< std::vector<ScheduledDelivery> > deliveries(numO);
+    const std::vector<ScheduledDelivery> &all = opt.getWarmStart()->getDeliveries();
+    for (size_t j = 0; j < all.size(); j++) {
+      deliveries[all[j].order].push_back(all[j]);
+    }
+
+    for (int i = 0; i < numO; i++) {
+      std::sort(deliveries[i].begin(), deliveries[i].end(), UnloadLess());
+
+      wsDeliveries[i] = std::min((int)deliveries[i].size(), O_numD[i]);
+      for (int d = 0; d < wsDeliveries[i]; d++) {
+        int k = O_first[i] + d;
+        wsVehicle[k] = deliveries[i][d].vehicle;
+        wsStation[k] = deliveries[i][d].station;
+        wsLoad   [k] = deliveries[i][d].tLoad;
+        wsUnload [k] = deliveries[i][d].tUnload;
+      }
+    }
+
+    branch(*this, O_Deliveries, INT_VAR_NONE(), INT_VAL_NEAR_MAX(wsDeliveries));
+    branch(*this, D_Vehicle,    INT_VAR_NONE(), INT_VAL_NEAR_MIN(wsVehicle));
+    branch(*this, D_Station,    INT_VAR_NONE(), INT_VAL_NEAR_MIN(wsStation));
+    branch(*this, D_tUnload,    INT_VAR_NONE(), INT_VAL_NEAR_MIN(wsUnload));
+    branch(*this, D_tLoad,      INT_VAR_NONE(), INT_VAL_NEAR_MAX(wsLoad));
+  }
+
+  branch(*this, O_Deliveries, INT_VAR_NONE(), INT_VAL_RANGE_MIN());
+
+  switch (opt.branching()) {
+  case BRANCH_TOURS:
+  // the serial schedule works on the tours of the vehicles, which this formulation does not have
+  case BRANCH_SGS:
+    branch(*this, D_Vehicle,    INT_VAR_NONE(), INT_VAL_MIN());
+    branch(*this, D_Station,    INT_VAR_NONE(), INT_VAL_MIN());
+    branch(*this, D_tUnload,    INT_VAR_NONE(), INT_VAL_MIN());
+    branch(*this, D_tLoad,      INT_VAR_NONE(), INT_VAL_RANGE_MAX());
+    branch(*this, D_Next,       INT_VAR_NONE(), INT_VAL_MIN());
+    break;
+  case BRANCH_FIRST_FAIL:
+    branch(*this, D_Vehicle,    INT_VAR_SIZE_MIN(), INT_VAL_MIN());
+    branch(*this, D_Station,    INT_VAR_SIZE_MIN(), INT_VAL_MIN());
+    branch(*this, D_tUnload,    INT_VAR_MIN_MIN(),  INT_VAL_MIN());
+    branch(*this, D_tLoad,      INT_VAR_NONE(),     INT_VAL_RANGE_MAX());
+    branch(*this, D_Next,       INT_VAR_SIZE_MIN(), INT_VAL_MIN());
+    break;
+  case BRANCH_AFC:
+    branch(*this, D_Vehicle,    INT_VAR_AFC_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_Station,    INT_VAR_AFC_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_tUnload,    INT_VAR_AFC_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_tLoad,      INT_VAR_NONE(), INT_VAL_RANGE_MAX());
+    branch(*this, D_Next,       INT_VAR_AFC_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    break;
+  case BRANCH_ACTIVITY:
+    // the random vehicles of the seed make restarts explore different tours
+    branch(*this, D_Vehicle,    INT_VAR_ACTIVITY_SIZE_MAX(opt.decay()), INT_VAL_RND(Rnd(opt.seed())));
+    branch(*this, D_Station,    INT_VAR_ACTIVITY_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_tUnload,    INT_VAR_ACTIVITY_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    branch(*this, D_tLoad,      INT_VAR_NONE(), INT_VAL_RANGE_MAX());
+    branch(*this, D_Next,       INT_VAR_ACTIVITY_SIZE_MAX(opt.decay()), INT_VAL_MIN());
+    break;
+  default:
+    break;
+  }
+
+  branch(*this, O_Lateness,   INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, O_tLag,       INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, D_Vehicle,    INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, O_Preferred,  INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, D_Station,    INT_VAR_NONE(), INT_VAL_MIN());
+
+  branch(*this, D_tUnload,    INT_VAR_NONE(), INT_VAL_MIN());
+  branch(*this, D_tLoad,      INT_VAR_NONE(), INT_VAL_RANGE_MAX());
+  branch(*this, D_Next,       INT_VAR_NONE(), INT_VAL_MIN());
+}
+
+RMCOrders::RMCOrders(bool share, RMCOrders &rmc)
+: RMCScript(share, rmc)
+{
+  O_Deliveries.update(*this, share, rmc.O_Deliveries);
+  D_Vehicle.update(*this, share, rmc.D_Vehicle);
+  D_Station.update(*this, share, rmc.D_Station);
+  D_tLoad.update(*this, share, rmc.D_tLoad);
+  D_tUnload.update(*this, share, rmc.D_tUnload);
+  D_Next.update(*this, share, rmc.D_Next);
+  Cost.update(*this, share, rmc.Cost);
+  O_Poured.update(*this, share, rmc.O_Poured);
+  O_Waste.update(*this, share, rmc.O_Waste);
+  O_Lateness.update(*this, share, rmc.O_Lateness);
+  O_tLag.update(*this, share, rmc.O_tLag);
+  O_Preferred.update(*this, share, rmc.O_Preferred);
+
+  Input = rmc.Input;
+  SolutionFile = rmc.SolutionFile;
+}
+
+void RMCOrders::fixSchedule(const Schedule &schedule)
+{
+  int numO = Input->getNumOrders();
+  const int *O_first = Input->getOrderDeliveryOffsets();
+  const int *O_numD = Input->getOrderMaxDeliveries();
+
+  std::vector< std::vector<ScheduledDelivery> > deliveries(numO);
+  const std::vector<ScheduledDelivery> &all = schedule.getDeliveries();
+  for (size_t j = 0; j < all.size(); j++) {
+    deliveries[all[j].order].push_back(all[j]);
+  }
+
+  for (int i = 0; i < numO; i++) {
+    std::sort(deliveries[i].begin(), deliveries[i].end(), UnloadLess());
+
+    int num = std::min((int)deliveries[i].size(), O_numD[i]);
+    rel(*this, O_Deliveries[i] >= num);
+
+    for (int d = 0; d < num; d++) {
+      rel(*this, D_Vehicle[O_first[i] + d] == deliveries[i][d].vehicle);
+      rel(*this, D_Station[O_first[i] + d] == deliveries[i][d].station);
+    }
+  }
+}
+
+void RMCOrders::relax(const Schedule &schedule, const Relaxation &relaxation)
+{
+  int numO = Input->getNumOrders();
+  const int *O_first = Input->getOrderDeliveryOffsets();
+  const int *O_numD = Input->getOrderMaxDeliveries();
+
+  // vehicles with a relaxed delivery, their other deliveries may move in time
+  const std::vector<ScheduledDelivery> &all = schedule.getDeliveries();
+  std::vector<bool> touched(Input->getNumVehicles(), false);
+  for (size_t j = 0; j < all.size(); j++) {
+    if (relaxation.deliveries[j]) touched[all[j].vehicle] = true;
+  }
+
+  // slots of an order are sorted by unloading time, relaxed deliveries keep their position
+  std::vector< std::vector<int> > deliveries(numO);
+  for (size_t j = 0; j < all.size(); j++) {
+    deliveries[all[j].order].push_back(j);
+  }
+
+  for (int i = 0; i < numO; i++) {
+    std::stable_sort(deliveries[i].begin(), deliveries[i].end(), IndexUnloadLess(all));
+
+    int num = std::min((int)deliveries[i].size(), O_numD[i]);
+    int lastFixed = -1;
+    bool anyRelaxed = false;
+    for (int d = 0; d < num; d++) {
+      const ScheduledDelivery &del = all[deliveries[i][d]];
+      if (relaxation.deliveries[deliveries[i][d]] || relaxation.vehicles[del.vehicle]) {
+        anyRelaxed = true;
+        continue;
+      }
+
+      int k = O_first[i] + d;
+      rel(*this, D_Vehicle[k], IRT_EQ, del.vehicle);
+      rel(*this, D_Station[k], IRT_EQ, del.station);
+      if (!touched[del.vehicle]) {
+        rel(*this, D_tLoad[k],   IRT_EQ, del.tLoad);
+        rel(*this, D_tUnload[k], IRT_EQ, del.tUnload);
+      }
+      lastFixed = d;
+    }
+
+    if (anyRelaxed) {
+      rel(*this, O_Deliveries[i], IRT_GQ, lastFixed + 1);
+    } else {
+      rel(*this, O_Deliveries[i], IRT_EQ, num);
+    }
+  }
+}
+
+void RMCOrders::getSchedule(Schedule &schedule) const
+{
+  int numO = Input->getNumOrders();
+  const int *O_first = Input->getOrderDeliveryOffsets();
+
+  // Deliveries are added per vehicle in the order of their tours
+  std::vector<ScheduledDelivery> deliveries;
+  for (int i = 0; i < numO; i++) {
+    for (int d = 0; d < O_Deliveries[i].val(); d++) {
+      int k = O_first[i] + d;
+      ScheduledDelivery del;
+      del.vehicle = D_Vehicle[k].val();
+      del.order = i;
+      del.station = D_Station[k].val();
+      del.tLoad = D_tLoad[k].val();
+      del.tUnload = D_tUnload[k].val();
+      deliveries.push_back(del);
+    }
+  }
+  std::sort(deliveries.begin(), deliveries.end(), TourLess());
+
+  schedule.clear();
+  for (size_t j = 0; j < deliveries.size(); j++) {
+    const ScheduledDelivery &d = deliveries[j];
+    schedule.addDelivery(d.vehicle, d.order, d.station, d.tLoad, d.tUnload);
+  }
+  schedule.setCost(Cost.val());
+}
+
+void RMCOrders::print(std::ostream &out) const {
+  if (SolutionFile) {
+    Schedule schedule;
+    getSchedule(schedule);
+    schedule.write(SolutionFile, *Input);
+  }
+
+  out << "Vehicles per delivery:\n";
+  out << D_Vehicle << std::endl;
+  out << "Stations per delivery:\n";
+  out << D_Station << std::endl;
+  out << "Load Times:\n";
+  out << D_tLoad << std::endl;
+  out << "Unload Times:\n";
+  out << D_tUnload << std::endl;
+  out << "Next deliveries:\n";
+  out << D_Next << std::endl;
+
+  out << "O_Preferred:\n";
+  out << O_Preferred << std::endl;
+  out << "O_tLag:\n";
+  out << O_tLag << std::endl;
+  out << std::endl;
+
+  out << "Number of deliveries per order:\n";
+  out << O_Deliveries << std::endl;
+  out << "Concrete poured per order:\n";
+  out << O_Poured << std::endl;
+  out << "Waste per order:\n";
+  out << O_Waste << std::endl;
+  out << "Lateness per order:\n";
+  out << O_Lateness << std::endl;
+  out << "Cost: " << Cost << std::endl;
+}
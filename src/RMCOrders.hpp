@@ -0,0 +1,99 @@
+/*
+ * RMCOrders.hpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#ifndef RMCORDERS_HPP_
+#define RMCORDERS_HPP_
+
+#include "RMC.hpp"
+
+/**
+ * Formulation with delivery slots per order (D_o). Row i of the per delivery arrays holds the
+ * deliveries of order i sorted by unloading time, so lateness, time lags and poured volume are
+ * plain sums. The tours of the vehicles are given by successor variables instead.
+ */
+class RMCOrders : public RMCScript {
+
+protected:
+
+  // ------------- Decision Variables ----------------
+
+  // Number of deliveries per order
+  IntVarArray O_Deliveries;
+
+  // Vehicle per delivery
+  IntVarArray D_Vehicle;
+
+  // Index of start station
+  IntVarArray D_Station;
+
+  // Timestamp when loading starts for delivery d
+  IntVarArray D_tLoad;
+
+  // Timestamp when unloading starts for delivery d
+  IntVarArray D_tUnload;
+
+  // Next delivery of the same vehicle, numD + d if d is the last delivery of its vehicle
+  IntVarArray D_Next;
+
+  // --------------- Optimization Goal ---------------
+
+  // Cost function value
+  IntVar Cost;
+
+  // --------------- Result values -------------------
+
+  // Total amount of concrete poured per order
+  IntVarArray O_Poured;
+
+  // Amount of waste per order
+  IntVarArray O_Waste;
+
+  // Lateness of orders
+  IntVarArray O_Lateness;
+
+  // Total time lag between the deliveries of orders
+  IntVarArray O_tLag;
+
+  BoolVarArray O_Preferred;
+
+  // ---------------- Other data ---------------------
+
+  // Input data, owned by the options, outlives all spaces
+  const RMCInput *Input;
+
+  // File to write schedules to, or NULL
+  const char *SolutionFile;
+public:
+  /// problem construction
+  RMCOrders(const RMCOptions &opt);
+
+  virtual ~RMCOrders() {}
+
+  /// copy support
+  RMCOrders(bool share, RMCOrders &rmc);
+
+  virtual Space* copy(bool share) {
+    return new RMCOrders(share, *this);
+  }
+
+  /// optimisation
+
+  virtual IntVar cost(void) const {
+    return Cost;
+  }
+
+  virtual void fixSchedule(const Schedule &schedule);
+
+  virtual void getSchedule(Schedule &schedule) const;
+
+  virtual void relax(const Schedule &schedule, const Relaxation &relaxation);
+
+  /// printing
+  void print(std::ostream &out) const;
+};
+
+#endif
@@ -6,8 +6,7 @@
  */
 
 #include "ReadXML.hpp"
-#include <libxml/parser.h>
-#include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 
 #include <time.h>
 #include <string.h>
@@ -15,7 +14,8 @@
 using namespace std;
 
 ReadXML::ReadXML(const char * filename) 
-: _filename(filename)
+: _filename(filename), _curOrder(NULL), _curVehicle(NULL), _curStation(NULL), _curYard(NULL),
+  _inStationDuration(false)
 {
 }
 
@@ -35,33 +35,85 @@ ReadXML::~ReadXML() {
     delete *its;
   }
   _stationList.clear();
+  for (size_t i = 0; i < _yardList.size(); i++) {
+    delete _yardList[i];
+  }
+  _yardList.clear();
 
+  delete _curOrder;
+  delete _curVehicle;
+  delete _curStation;
+  delete _curYard;
 }
 
-void ReadXML::parseFile() {
-  xmlDoc *doc = NULL;
-  xmlNode *root_element = NULL;
-
-  /*parse the file and get the DOM */
-  doc = xmlReadFile(_filename, NULL, 0);
-
-  if (doc == NULL) {
-    printf("error: could not parse file %s\n", _filename);
-    exit(0);
+/*
+ * parse a timestamp of the form 2011-01-11T14:00:40, returns false on errors
+ */
+static bool parseTimeStamp(const std::string &str, time_t &timeStamp) {
+  struct tm t = {0,0,0,0,0,0,0,0,0};
+  const char *rs = strptime(str.c_str(), "%Y-%m-%dT%H:%M:%S", &t);
+  if (!rs || (*rs != '\0' && *rs != '.')) {
+    return false;
   }
+  timeStamp = mktime(&t);
+  return true;
+}
 
-  /*Get the root element node */
-  root_element = xmlDocGetRootElement(doc);
+void ReadXML::initParser() {
+  xmlInitParser();
+}
+
+void ReadXML::cleanupParser() {
+  xmlCleanupParser();
+}
 
-  processFile(root_element->children);
-  /*free the document */
-  xmlFreeDoc(doc);
+bool ReadXML::parseFile() {
+  xmlTextReaderPtr reader = NULL;
 
   /*
-   *Free the global variables that may
-   *have been allocated by the parser.
+   * Stream through the file instead of building the DOM, so that memory does not
+   * grow with the size of the file but only with the number of records we keep.
    */
-  xmlCleanupParser();
+  reader = xmlReaderForFile(_filename, NULL, 0);
+
+  if (reader == NULL) {
+    printf("error: could not open file %s\n", _filename);
+    return false;
+  }
+
+  int ret;
+  while ((ret = xmlTextReaderRead(reader)) == 1) {
+    switch (xmlTextReaderNodeType(reader)) {
+    case XML_READER_TYPE_ELEMENT: {
+      const xmlChar *name = xmlTextReaderConstName(reader);
+      startElement(name);
+      // <Foo/> does not generate an end element
+      if (xmlTextReaderIsEmptyElement(reader)) {
+        endElement(name);
+      }
+      break;
+    }
+    case XML_READER_TYPE_TEXT:
+    case XML_READER_TYPE_CDATA:
+      _text.append((const char*) xmlTextReaderConstValue(reader));
+      break;
+    case XML_READER_TYPE_END_ELEMENT:
+      endElement(xmlTextReaderConstName(reader));
+      break;
+    default:
+      break;
+    }
+  }
+
+  xmlFreeTextReader(reader);
+
+  if (ret != 0) {
+    printf("error: could not parse file %s\n", _filename);
+    return false;
+  }
+
+  // Note: the parser globals are shared between threads and are freed by cleanupParser()
+  return true;
 }
 
 
@@ -72,10 +124,12 @@ void ReadXML::print(){
       cout<<(*ite)->_orderCode<<endl;
       cout<<(*ite)->_dischargeRate<<endl;
       cout<<(*ite)->_startTime<<endl;
-      cout<<"const yard"<<(*ite)->_constructionYard->_code<<endl;
+      if ((*ite)->_constructionYard == -1) continue;
+      XMLConstructionYard *yard = _yardList[(*ite)->_constructionYard];
+      cout<<"const yard"<<yard->_code<<endl;
       list<XMLStationDuration>::iterator site;
-      for(site = (*ite)->_constructionYard->_stationDuration.begin(); site!= (*ite)->_constructionYard->_stationDuration.end(); site++){
-        cout<< site->_drivingMinutes<< " code "<< site->_stationCode<<endl;
+      for(site = yard->_stationDuration.begin(); site!= yard->_stationDuration.end(); site++){
+        cout<< site->_drivingMinutes<< " code "<< _stationCodes[site->_station]<<endl;
       }
     }
     //some information about vehicle
@@ -91,254 +145,252 @@ void ReadXML::print(){
     }
 
 }
-/**
- * iterate over top level structure /orders/vehicles/sites :
- * @a_node: the initial xml node to consider.
- *
- * Iterates over the top level nodes and calls the appropriate reader for each of them
+/*
+ * called for every opening tag; creates a new record for Order, Vehicle, Station,
+ * ConstructionYard and StationDuration elements, and starts collecting the text
+ * of everything else.
  */
-void ReadXML::processFile(xmlNode * a_node)
-{
-    xmlNode *cur_node = NULL;
-
-    for (cur_node = a_node; cur_node; cur_node = cur_node->next) {
-        if (cur_node->type == XML_ELEMENT_NODE && !xmlStrcmp(cur_node->name, (const xmlChar*)"Orders") ) {
-
-          xmlNode* order = NULL;
-            for(order = cur_node->children; order ; order = order->next){
-              if(!xmlStrcmp(order->name , (const xmlChar*)"Order")){
-              readOrders(order);
-              }
-            }
-            continue;
-        }
-        if (cur_node->type == XML_ELEMENT_NODE && !xmlStrcmp(cur_node->name, (const xmlChar*)"Vehicles") ) {
-
-      xmlNode* order = NULL;
-      for (order = cur_node->children; order; order = order->next) {
-        if (!xmlStrcmp(order->name, (const xmlChar*) "Vehicle")) {
-          readVehicles(order);
-        }
-      }
-      continue;
-    }
-        if (cur_node->type == XML_ELEMENT_NODE && !xmlStrcmp(cur_node->name, (const xmlChar*)"Stations") ) {
-
-      xmlNode* order = NULL;
-      for (order = cur_node->children; order; order = order->next) {
-        if (!xmlStrcmp(order->name, (const xmlChar*) "Station")) {
-          readStations(order);
-        }
-      }
-      continue;
-    }
-    }
+void ReadXML::startElement(const xmlChar* name) {
+  _text.clear();
 
+  if (!xmlStrcmp(name, (const xmlChar*) "Order")) {
+    delete _curOrder;
+    _curOrder = new XMLOrder();
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "ConstructionYard")) {
+    delete _curYard;
+    _curYard = new XMLConstructionYard();
+    _curYard->_waitingMinutes = 0;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "StationDuration")) {
+    _curDuration = XMLStationDuration();
+    _inStationDuration = true;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "Vehicle")) {
+    delete _curVehicle;
+    _curVehicle = new XMLVehicle();
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "Station")) {
+    delete _curStation;
+    _curStation = new XMLStation();
+    return;
+  }
 }
 
 /*
- * traverse all the orders and collect information for each of them. And put it in the list of informations
+ * called for every closing tag; either finishes a record and moves it to its list or
+ * stores the collected text in the field of the innermost open record
  */
-void ReadXML::readOrders(xmlNode* order) {
-  xmlNode * iter = NULL;
-  XMLOrder *o = new XMLOrder();
-
-  for (iter = order->children; iter; iter = iter->next) {
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "OrderCode")) {
-      o->_orderCode = (char*)xmlNodeGetContent(iter);
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "PumpLineLengthRequired")) {
-      o->_pumpLength = atoi((char*)xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "From")) {
-      o->_startTime = (char*) xmlNodeGetContent(iter);
-      struct tm t = {0,0,0,0,0,0,0,0,0};
-      char *rs = strptime(o->_startTime.c_str(), "%Y-%m-%dT%H:%M:%S", &t);
-      if (!rs || (*rs != '\0' && *rs != '.'))
-        cout << "error parsing " << o->_startTime << endl;
-      else {
-        time_t timeStamp = mktime(&t);
-        o->_unixTimeStamp = timeStamp;
-      }
+void ReadXML::endElement(const xmlChar* name) {
+  if (!xmlStrcmp(name, (const xmlChar*) "Order")) {
+    if (_curOrder) _orderList.push_back(_curOrder);
+    _curOrder = NULL;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "ConstructionYard")) {
+    if (!_curYard) return;
 
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "TotalVolumeM3")) {
-      o->_volume = atof((char*)xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "RequiredDischargeM3PerHour")) {
-      o->_dischargeRate = atof((char*)xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "PreferredStationCode")) {
-      o->_preferredStationCode = ((char*)xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "MaximumVolumeAllowed")) {
-      if(!xmlStrcmp(xmlNodeGetContent(iter),(const xmlChar*)"true")){
-        o->_maxVolumeAllowed = true;
-      } else o->_maxVolumeAllowed = false;
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "IsPickUp")) {
-      if(!xmlStrcmp(xmlNodeGetContent(iter),(const xmlChar*)"true")){
-              o->_isPickup = true;
-      } else o->_isPickup = false;
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "Priority")) {
-      o->_priority = atoi((char*)xmlNodeGetContent(iter));
-      continue;
-    }
+    int idx = internConstructionYard(_curYard);
+    if (_curOrder) _curOrder->_constructionYard = idx;
 
-    //read construction yard information
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "ConstructionYard")) {
-      XMLConstructionYard cyard;
-      o->_constructionYard = readConstructionYard(iter);
+    _curYard = NULL;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "StationDuration")) {
+    //add another station duration info to the list of the construction yard
+    if (_curYard) _curYard->_stationDuration.push_back(_curDuration);
+    _inStationDuration = false;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "Vehicle")) {
+    if (_curVehicle) _vehicleList.push_back(_curVehicle);
+    _curVehicle = NULL;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "Station")) {
+    if (_curStation) _stationList.push_back(_curStation);
+    _curStation = NULL;
+    return;
+  }
 
-    }
+  // leaf element, assign to the innermost record
+  if (_inStationDuration) {
+    setStationDurationField(name);
+  } else if (_curYard) {
+    setConstructionYardField(name);
+  } else if (_curOrder) {
+    setOrderField(name);
+  } else if (_curVehicle) {
+    setVehicleField(name);
+  } else if (_curStation) {
+    setStationField(name);
   }
-  _orderList.push_back(o);
 }
 
-/*
- * traverse all the vehicle nodes and collect information about each of them and collect them in the
- * list of vehicles
- */
-void ReadXML::readVehicles(xmlNode* vehicles) {
-  xmlNode * iter = NULL;
-  XMLVehicle *o = new XMLVehicle();
+void ReadXML::setOrderField(const xmlChar* name) {
+  XMLOrder *o = _curOrder;
 
-  for (iter = vehicles->children; iter; iter = iter->next) {
+  if (!xmlStrcmp(name, (const xmlChar*) "OrderCode")) {
+    o->_orderCode = _text;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "PumpLineLengthRequired")) {
+    o->_pumpLength = atoi(_text.c_str());
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "From")) {
+    o->_startTime = _text;
+    if (!parseTimeStamp(o->_startTime, o->_unixTimeStamp))
+      cout << "error parsing " << o->_startTime << endl;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "TotalVolumeM3")) {
+    o->_volume = atof(_text.c_str());
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "RequiredDischargeM3PerHour")) {
+    o->_dischargeRate = atof(_text.c_str());
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "PreferredStationCode")) {
+    o->_preferredStationCode = _text;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "MaximumVolumeAllowed")) {
+    o->_maxVolumeAllowed = (_text == "true");
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "IsPickUp")) {
+    o->_isPickup = (_text == "true");
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "Priority")) {
+    o->_priority = atoi(_text.c_str());
+    return;
+  }
+}
 
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "VehicleCode")) {
-      o->_vehicleCode = ((char*)xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "VehicleType")) {
-      o->_vehicleType = ((char*)xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "NormalVolume")) {
-      o->_normalVolume = atoi((char*) xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "PumpLineLength")) {
-      o->_pumpLength = atoi((char*)xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "MaximumVolume")) {
-      o->_maximumVolume = atoi((char*) xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "DischargeM3PerHour")) {
-      o->_dischargeRate = atof((char*) xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name,(const xmlChar*) "NextAvailableStartDateTime")) {
-      o->_nextAvailableTime = ((char*) xmlNodeGetContent(iter));
-
-      struct tm t = {0,0,0,0,0,0,0,0,0};
-      char *rs = strptime(o->_nextAvailableTime.c_str(), "%Y-%m-%dT%H:%M:%S", &t);
-      if (!rs || (*rs != '\0' && *rs != '.'))
-        cout << "error parsing " << o->_nextAvailableTime << endl;
-      else {
-        time_t timeStamp = mktime(&t);
-        o->_nextAvailabelTimeStampUnix = timeStamp;
-      }
+void ReadXML::setVehicleField(const xmlChar* name) {
+  XMLVehicle *o = _curVehicle;
 
-      continue;
-    }
+  if (!xmlStrcmp(name, (const xmlChar*) "VehicleCode")) {
+    o->_vehicleCode = _text;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "VehicleType")) {
+    o->_vehicleType = _text;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "NormalVolume")) {
+    o->_normalVolume = atoi(_text.c_str());
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "PumpLineLength")) {
+    o->_pumpLength = atoi(_text.c_str());
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "MaximumVolume")) {
+    o->_maximumVolume = atoi(_text.c_str());
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "DischargeM3PerHour")) {
+    o->_dischargeRate = atof(_text.c_str());
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "NextAvailableStartDateTime")) {
+    o->_nextAvailableTime = _text;
+    if (!parseTimeStamp(o->_nextAvailableTime, o->_nextAvailabelTimeStampUnix))
+      cout << "error parsing " << o->_nextAvailableTime << endl;
+    return;
   }
-  _vehicleList.push_back(o);
 }
 
-/*
- * traverse all the station nodes and collect information about each of them and collect them in the
- * list of station
- */
-void ReadXML::readStations(xmlNode* stations) {
-  xmlNode * iter = NULL;
+void ReadXML::setStationField(const xmlChar* name) {
+  XMLStation *o = _curStation;
 
-  XMLStation *o = new XMLStation();
+  if (!xmlStrcmp(name, (const xmlChar*) "StationCode")) {
+    o->_stationCode = _text;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "LoadingMinutes")) {
+    o->_loadingMinutes = atoi(_text.c_str());
+    return;
+  }
+}
 
-  for (iter = stations->children; iter; iter = iter->next) {
+void ReadXML::setConstructionYardField(const xmlChar* name) {
+  XMLConstructionYard *cya = _curYard;
 
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "StationCode")) {
-      o->_stationCode = ((char*)xmlNodeGetContent(iter));
-      continue;
-    }
-    if (!xmlStrcmp(iter->name, (const xmlChar*) "LoadingMinutes")) {
-      o->_loadingMinutes = atoi((char*)xmlNodeGetContent(iter));
-      continue;
-    }
+  if (!xmlStrcmp(name, (const xmlChar*) "ConstructionYardCode")) {
+    cya->_code = _text;
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "WaitingMinutes")) {
+    cya->_waitingMinutes = atoi(_text.c_str());
+    return;
   }
-  _stationList.push_back(o);
 }
 
-/*
- * traverse a node containing construction yards information and return a construction yard
- */
-XMLConstructionYard *ReadXML::readConstructionYard(xmlNode* cyard) {
-  XMLConstructionYard *cya = new XMLConstructionYard();
-  xmlNode* ci = NULL;
-
-  for (ci = cyard->children; ci; ci = ci->next) {
-    if (!xmlStrcmp(ci->name, (const xmlChar*) "ConstructionYardCode")) {
-      cya->_code = (char*) xmlNodeGetContent(ci);
-      continue;
-    }
+void ReadXML::setStationDurationField(const xmlChar* name) {
+  XMLStationDuration &st = _curDuration;
 
-    if (!xmlStrcmp(ci->name, (const xmlChar*) "WaitingMinutes")) {
-      cya->_waitingMinutes = atoi((char*) xmlNodeGetContent(ci));
-      continue;
-    }
+  if (!xmlStrcmp(name, (const xmlChar*) "StationCode")) {
+    st._station = internStationCode(_text);
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "DrivingMinutes")) {
+    st._drivingMinutes = atoi(_text.c_str());
+    return;
+  }
+  if (!xmlStrcmp(name, (const xmlChar*) "Direction")) {
+    st._direction = (_text == "To");
+    return;
+  }
+}
 
-    //read Station duration here
-    if (!xmlStrcmp(ci->name, (const xmlChar*) "StationDurations")) {
-
-      xmlNode* constSite = NULL;
-      /*
-       * traverse all the station duration nodes and collect information from each of them
-       * afterwards add the information to the corresponding list of stationDurations
-       */
-      for(constSite = ci->children; constSite; constSite=constSite->next){
-
-        if (!xmlStrcmp(constSite->name, (const xmlChar*) "StationDuration")) {
-
-          xmlNode* station = NULL;
-          XMLStationDuration st;
-          for(station = constSite->children; station; station= station->next){
-
-            if (!xmlStrcmp(station->name, (const xmlChar*) "StationCode")){
-             st._stationCode = (char*) xmlNodeGetContent(station);
-            continue;
-            }
-            if (!xmlStrcmp(station->name, (const xmlChar*) "DrivingMinutes")) {
-              st._drivingMinutes = atoi((char*) xmlNodeGetContent(station));
-              continue;
-            }
-            if (!xmlStrcmp(station->name, (const xmlChar*) "Direction")) {
-
-              if (!xmlStrcmp(xmlNodeGetContent(station),(const xmlChar*)"To")) {
-                st._direction = true;
-              } else
-                 st._direction = false;
-              continue;
-            }
-
-          }
-          //add another station duration info to the list of the construction yard
-          cya->_stationDuration.push_back(st);
-        }
+int ReadXML::internStationCode(const std::string &code) {
+  std::map<std::string, int>::const_iterator it = _stationCodeIndex.find(code);
+  if (it != _stationCodeIndex.end()) {
+    return it->second;
+  }
+  int idx = _stationCodes.size();
+  _stationCodes.push_back(code);
+  _stationCodeIndex.insert(std::pair<std::string,int>(code, idx));
+  return idx;
+}
 
-      }
-      continue;
+/*
+ * returns the index of a yard with the same data, or adds the yard to the list.
+ * Takes ownership of the yard.
+ */
+int ReadXML::internConstructionYard(XMLConstructionYard *yard) {
+  typedef std::multimap<std::string, int>::const_iterator iterator;
+  std::pair<iterator, iterator> range = _yardIndex.equal_range(yard->_code);
+
+  for (iterator it = range.first; it != range.second; it++) {
+    const XMLConstructionYard &other = *_yardList[it->second];
+    if (other._waitingMinutes != yard->_waitingMinutes ||
+        other._stationDuration.size() != yard->_stationDuration.size()) continue;
+
+    bool same = true;
+    list<XMLStationDuration>::const_iterator a = other._stationDuration.begin();
+    list<XMLStationDuration>::const_iterator b = yard->_stationDuration.begin();
+    for (; same && a != other._stationDuration.end(); a++, b++) {
+      same = a->_station == b->_station && a->_drivingMinutes == b->_drivingMinutes &&
+             a->_direction == b->_direction;
+    }
+    if (same) {
+      delete yard;
+      return it->second;
     }
   }
-  //return the new construction site
-  return cya;
+
+  int idx = _yardList.size();
+  _yardList.push_back(yard);
+  _yardIndex.insert(std::pair<std::string,int>(yard->_code, idx));
+  return idx;
 }
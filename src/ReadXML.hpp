@@ -10,11 +10,12 @@
 
 #include <iostream>
 #include <list>
+#include <map>
+#include <string>
 #include <vector>
 
 #include <stdio.h>
-#include <libxml/parser.h>
-#include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 
 #include "XMLDataTypes.hpp"
 
@@ -24,7 +25,14 @@ public:
   
   virtual ~ReadXML();
 
-  void parseFile();
+  /// parse the file, returns false if the file could not be read
+  bool parseFile();
+  
+  /// initialize the libxml2 globals, must be called once before parsing from several threads
+  static void initParser();
+  
+  /// free the libxml2 globals, must only be called when no other thread is parsing
+  static void cleanupParser();
   
   void print();
 
@@ -43,17 +51,48 @@ public:
     std::copy( _stationList.begin(), _stationList.end(), std::back_inserter( vec ) );
   }
 
+  /// construction yards, indexed by XMLOrder::_constructionYard
+  void getConstructionYardsList(std::vector<XMLConstructionYard*> &vec){
+    vec = _yardList;
+  }
+
+  /// number of distinct station codes used in station durations
+  int getNumStationCodes() const { return _stationCodes.size(); }
+
+  /// station code for XMLStationDuration::_station
+  const std::string &getStationCode(int idx) const { return _stationCodes[idx]; }
+
 
 private:
-  void processFile(xmlNode* node);
-  void readOrders(xmlNode* orders);
-  void readVehicles(xmlNode* vehicles);
-  void readStations(xmlNode* stations);
+  void startElement(const xmlChar* name);
+  void endElement(const xmlChar* name);
+
+  void setOrderField(const xmlChar* name);
+  void setVehicleField(const xmlChar* name);
+  void setStationField(const xmlChar* name);
+  void setConstructionYardField(const xmlChar* name);
+  void setStationDurationField(const xmlChar* name);
 
-  XMLConstructionYard *readConstructionYard(xmlNode* cyard);
+  int internStationCode(const std::string &code);
+
+  int internConstructionYard(XMLConstructionYard *yard);
 
   //file to be parsed
   const char* _filename;
+
+  /*
+   * Records currently being filled by the reader, NULL if we are not inside such an element
+   */
+  XMLOrder* _curOrder;
+  XMLVehicle* _curVehicle;
+  XMLStation* _curStation;
+  XMLConstructionYard* _curYard;
+  XMLStationDuration _curDuration;
+  bool _inStationDuration;
+  /*
+   * Text content of the current leaf element, reused for all elements
+   */
+  std::string _text;
   /*
    * List of orders
    */
@@ -66,6 +105,18 @@ private:
    * List of stations
    */
   std::list<XMLStation*> _stationList;
+  /*
+   * List of distinct construction yards, and indices of the yards per code. Codes
+   * are not unique (e.g. 'NN' for unknown yards), so yards are only shared if they
+   * have the same code and the same data.
+   */
+  std::vector<XMLConstructionYard*> _yardList;
+  std::multimap<std::string, int> _yardIndex;
+  /*
+   * Table of distinct station codes used by station durations
+   */
+  std::vector<std::string> _stationCodes;
+  std::map<std::string, int> _stationCodeIndex;
 };
 
 #endif /* READXML_HPP_ */
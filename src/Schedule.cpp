@@ -0,0 +1,217 @@
+/*
+ * Schedule.cpp
+ *
+ *  Created on: Mar 18, 2014
+ *  Author: stefan
+ *
+ * Schedule files are tab separated text:
+ *   cost <cost>
+ *   delivery <VehicleCode> <OrderCode> <StationCode> <load time> <unload time>
+ * with times as unix time stamps, so that they can be read for the planning file of another day.
+ */
+
+#include "Schedule.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+void Schedule::addDelivery(int vehicle, int order, int station, int tLoad, int tUnload)
+{
+  ScheduledDelivery d;
+  d.vehicle = vehicle;
+  d.order = order;
+  d.station = station;
+  d.tLoad = tLoad;
+  d.tUnload = tUnload;
+  _deliveries.push_back(d);
+}
+
+void Schedule::getVehicleDeliveries(int vehicle, std::vector<ScheduledDelivery> &deliveries) const
+{
+  deliveries.clear();
+  for (size_t i = 0; i < _deliveries.size(); i++) {
+    if (_deliveries[i].vehicle == vehicle) {
+      deliveries.push_back(_deliveries[i]);
+    }
+  }
+}
+
+/// Tour of a vehicle as seen by the model: number of deliveries, then the order of every slot
+typedef std::pair< std::vector<int>, int > VehicleTour;
+
+static bool tourGreater(const VehicleTour &a, const VehicleTour &b)
+{
+  return a.first > b.first;
+}
+
+void Schedule::sortEquivalentVehicles(const RMCInput &input)
+{
+  int numV = input.getNumVehicles();
+  const int *classes = input.getVehicleClasses();
+  
+  std::vector<int> vehicleMap(numV);
+  std::vector<ScheduledDelivery> deliveries;
+  
+  for (int c = 0; c < numV; c++) {
+    if (classes[c] != c) continue;
+    
+    std::vector<VehicleTour> tours;
+    std::vector<int> members;
+    for (int i = c; i < numV; i++) {
+      if (classes[i] != c) continue;
+      
+      getVehicleDeliveries(i, deliveries);
+      
+      int slots = input.getMaxVehicleDeliveries(i);
+      int num = std::min((int) deliveries.size(), slots);
+      std::vector<int> tour(1 + slots, 0);
+      tour[0] = num;
+      for (int d = 0; d < num; d++) {
+        tour[1 + d] = deliveries[d].order;
+      }
+      tours.push_back(VehicleTour(tour, i));
+      members.push_back(i);
+    }
+    
+    std::stable_sort(tours.begin(), tours.end(), tourGreater);
+    for (size_t j = 0; j < tours.size(); j++) {
+      vehicleMap[tours[j].second] = members[j];
+    }
+  }
+  
+  for (size_t i = 0; i < _deliveries.size(); i++) {
+    _deliveries[i].vehicle = vehicleMap[_deliveries[i].vehicle];
+  }
+}
+
+int Schedule::computeCost(const RMCInput &input) const
+{
+  int numO = input.getNumOrders();
+  int numV = input.getNumVehicles();
+  
+  long long lateness = 0, waste = 0, preferred = 0, lag = 0, travel = 0;
+  
+  // unloading start and duration of all deliveries per order
+  std::vector< std::vector< std::pair<int,int> > > unloads(numO);
+  std::vector<long long> poured(numO, 0);
+  
+  for (int v = 0; v < numV; v++) {
+    std::vector<ScheduledDelivery> deliveries;
+    getVehicleDeliveries(v, deliveries);
+    
+    for (size_t d = 0; d < deliveries.size(); d++) {
+      const ScheduledDelivery &del = deliveries[d];
+      const Order &o = input.getOrder(del.order);
+      
+      int volume = input.getOrderVehicleVolumes()[del.order * numV + v];
+      int duration = input.getUnloadingTime(del.order, v);
+      
+      poured[del.order] += std::min(volume, (input.getTimeMax() - del.tUnload + del.tLoad) * o.dischargeRate());
+      unloads[del.order].push_back(std::make_pair(del.tUnload, duration));
+      
+      if (del.station != o.preferredStation()) preferred++;
+      
+      travel += input.getTravelTimeTo(del.order, del.station);
+      // no travel back after the last delivery
+      if (d + 1 < deliveries.size()) {
+        travel += input.getTravelTimeFrom(del.order, deliveries[d+1].station);
+      }
+    }
+  }
+  
+  for (int i = 0; i < numO; i++) {
+    if (unloads[i].empty()) continue;
+    
+    std::sort(unloads[i].begin(), unloads[i].end());
+    
+    lateness += unloads[i][0].first - input.getOrder(i).timeStart();
+    waste += poured[i] - input.getOrder(i).totalVolume();
+    
+    // time lag between the end of an unloading and the start of the next one
+    for (size_t d = 1; d < unloads[i].size(); d++) {
+      lag += unloads[i][d].first - unloads[i][d-1].first - unloads[i][d-1].second;
+    }
+  }
+  
+  long long cost = lateness * input.getAlpha1() + waste * input.getAlpha2() + preferred * input.getAlpha3() +
+                   lag * input.getAlpha4() + travel * input.getAlpha5();
+  
+  return (int) std::min(cost, (long long) INT_MAX);
+}
+
+void Schedule::print(std::ostream &out, const RMCInput &input) const
+{
+  out << "cost\t" << _cost << "\n";
+  for (size_t i = 0; i < _deliveries.size(); i++) {
+    const ScheduledDelivery &d = _deliveries[i];
+    out << "delivery\t" << input.getVehicle(d.vehicle).name() << "\t" << input.getOrder(d.order).name() << "\t"
+        << input.getStation(d.station).name() << "\t"
+        << input.getBaseTimeStamp() + d.tLoad << "\t" << input.getBaseTimeStamp() + d.tUnload << "\n";
+  }
+}
+
+bool Schedule::write(const char *filename, const RMCInput &input) const
+{
+  std::ofstream out(filename);
+  if (!out) {
+    std::cerr << "error: could not write schedule " << filename << "\n";
+    return false;
+  }
+  
+  print(out, input);
+  
+  return out.good();
+}
+
+bool Schedule::read(const char *filename, const RMCInput &input)
+{
+  std::ifstream in(filename);
+  if (!in) {
+    std::cerr << "error: could not read schedule " << filename << "\n";
+    return false;
+  }
+  
+  std::map<std::string, int> orders;
+  std::map<std::string, int> vehicles;
+  for (int i = 0; i < input.getNumOrders(); i++) {
+    orders[input.getOrder(i).name()] = i;
+  }
+  for (int i = 0; i < input.getNumVehicles(); i++) {
+    vehicles[input.getVehicle(i).name()] = i;
+  }
+  
+  clear();
+  
+  std::string line;
+  while (std::getline(in, line)) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, '\t')) {
+      fields.push_back(field);
+    }
+    
+    if (fields.size() == 2 && fields[0] == "cost") {
+      _cost = atoi(fields[1].c_str());
+      continue;
+    }
+    if (fields.size() != 6 || fields[0] != "delivery") continue;
+    
+    std::map<std::string, int>::const_iterator v = vehicles.find(fields[1]);
+    std::map<std::string, int>::const_iterator o = orders.find(fields[2]);
+    int station = input.getStation(fields[3]);
+    
+    if (v == vehicles.end() || o == orders.end() || station == -1) continue;
+    
+    addDelivery(v->second, o->second, station, 
+                (int)(atol(fields[4].c_str()) - input.getBaseTimeStamp()),
+                (int)(atol(fields[5].c_str()) - input.getBaseTimeStamp()));
+  }
+  
+  return true;
+}
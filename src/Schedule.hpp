@@ -0,0 +1,70 @@
+/*
+ * Schedule.hpp
+ *
+ *  Created on: Mar 18, 2014
+ *  Author: stefan
+ */
+
+#ifndef SCHEDULE_HPP_
+#define SCHEDULE_HPP_
+
+#include "Problem.hpp"
+
+#include <ostream>
+#include <vector>
+
+/// A single delivery of a solution, indices refer to an RMCInput
+struct ScheduledDelivery {
+  int vehicle;
+  int order;
+  int station;
+  int tLoad;
+  int tUnload;
+};
+
+/**
+ * A solution as a list of deliveries, independent of the model that found it.
+ * Deliveries of a vehicle are kept in the order in which the vehicle performs them.
+ */
+class Schedule {
+public:
+  Schedule() : _cost(-1) {}
+  
+  void clear() { _deliveries.clear(); _cost = -1; }
+  
+  void addDelivery(int vehicle, int order, int station, int tLoad, int tUnload);
+  
+  const std::vector<ScheduledDelivery>& getDeliveries() const { return _deliveries; }
+  
+  /// Get all deliveries of a vehicle in tour order
+  void getVehicleDeliveries(int vehicle, std::vector<ScheduledDelivery> &deliveries) const;
+  
+  /// Cost of the schedule, -1 if unknown
+  int getCost() const { return _cost; }
+  
+  void setCost(int cost) { _cost = cost; }
+  
+  /// Permute equivalent vehicles so that their tours are ordered as required by the symmetry
+  /// breaking of the RMC model: decreasing by number of deliveries, then by orders
+  void sortEquivalentVehicles(const RMCInput &input);
+  
+  /// Compute the cost of the schedule as defined by the RMC model
+  int computeCost(const RMCInput &input) const;
+  
+  /// Print the schedule using codes and absolute time stamps
+  void print(std::ostream &out, const RMCInput &input) const;
+  
+  /// Write the schedule to a file as printed by print(), returns false on errors
+  bool write(const char *filename, const RMCInput &input) const;
+  
+  /// Read a schedule written for a possibly different instance. Orders, vehicles and stations
+  /// are matched by their codes, deliveries that cannot be matched are dropped.
+  bool read(const char *filename, const RMCInput &input);
+  
+private:
+  std::vector<ScheduledDelivery> _deliveries;
+  
+  int _cost;
+};
+
+#endif
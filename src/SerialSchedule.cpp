@@ -0,0 +1,319 @@
+/*
+ * SerialSchedule.cpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#include "SerialSchedule.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+class SerialSchedule : public Brancher {
+protected:
+  ViewArray<Int::IntView> _deliveries;
+  ViewArray<Int::IntView> _order;
+  ViewArray<Int::IntView> _station;
+  ViewArray<Int::IntView> _tLoad;
+  ViewArray<Int::IntView> _tUnload;
+
+  SharedArray<int> _first;
+  SharedArray<int> _slots;
+  SharedArray<int> _startTimes;
+  SharedArray<int> _setupTimes;
+  SharedArray<int> _loadTimes;
+  SharedArray<int> _travelTo;
+
+  enum Kind {
+    SLOT_ASSIGN,  ///< order and station of a slot, or the end of the tour
+    SLOT_UNLOAD,  ///< start of unloading: value, or later
+    SLOT_LOAD,    ///< start of loading: value, or earlier
+    TOUR_END      ///< number of deliveries of a complete tour: value, or more
+  };
+
+  class SlotChoice : public Choice {
+  public:
+    int kind;
+    int vehicle;
+    int slot;
+    int value;
+    // order and station of every alternative of SLOT_ASSIGN, an extra alternative ends the tour
+    std::vector<int> orders;
+    std::vector<int> stations;
+
+    SlotChoice(const Brancher &b, unsigned int alternatives, int k, int v, int s, int val)
+    : Choice(b, alternatives), kind(k), vehicle(v), slot(s), value(val)
+    {}
+
+    virtual size_t size() const
+    {
+      return sizeof(*this) + (orders.size() + stations.size()) * sizeof(int);
+    }
+
+    virtual void archive(Archive &e) const
+    {
+      Choice::archive(e);
+      e << alternatives() << kind << vehicle << slot << value << (int) orders.size();
+      for (size_t i = 0; i < orders.size(); i++) {
+        e << orders[i] << stations[i];
+      }
+    }
+  };
+
+  /// Order and station for a slot, with the earliest start of unloading
+  struct Candidate {
+    long long unload;
+    int order;
+    int station;
+
+    bool operator<(const Candidate &c) const
+    {
+      return unload < c.unload || (unload == c.unload && (order < c.order ||
+                                                          (order == c.order && station < c.station)));
+    }
+  };
+
+  SerialSchedule(Space &home, bool share, SerialSchedule &b)
+  : Brancher(home, share, b)
+  {
+    _deliveries.update(home, share, b._deliveries);
+    _order.update(home, share, b._order);
+    _station.update(home, share, b._station);
+    _tLoad.update(home, share, b._tLoad);
+    _tUnload.update(home, share, b._tUnload);
+    _first.update(home, share, b._first);
+    _slots.update(home, share, b._slots);
+    _startTimes.update(home, share, b._startTimes);
+    _setupTimes.update(home, share, b._setupTimes);
+    _loadTimes.update(home, share, b._loadTimes);
+    _travelTo.update(home, share, b._travelTo);
+  }
+
+  /// First slot of the vehicle with an unassigned variable that may be used, -1 if there is none
+  int openSlot(int vehicle) const
+  {
+    int last = std::min(_slots[vehicle], _deliveries[vehicle].max());
+    for (int d = 0; d < last; d++) {
+      int k = _first[vehicle] + d;
+      if (!_order[k].assigned() || !_station[k].assigned() || !_tLoad[k].assigned() || !_tUnload[k].assigned()) {
+        return d;
+      }
+    }
+    return -1;
+  }
+
+  /// True if order and station of the open slot are fixed and it is used, so only times are left
+  bool onlyTimes(int vehicle, int slot) const
+  {
+    int k = _first[vehicle] + slot;
+    return slot < _deliveries[vehicle].min() && _order[k].assigned() && _station[k].assigned();
+  }
+
+public:
+  SerialSchedule(Home home, ViewArray<Int::IntView> &deliveries, ViewArray<Int::IntView> &order,
+                 ViewArray<Int::IntView> &station, ViewArray<Int::IntView> &tLoad,
+                 ViewArray<Int::IntView> &tUnload, const SharedArray<int> &first, const SharedArray<int> &slots,
+                 const SharedArray<int> &startTimes, const SharedArray<int> &setupTimes,
+                 const SharedArray<int> &loadTimes, const SharedArray<int> &travelTo)
+  : Brancher(home), _deliveries(deliveries), _order(order), _station(station), _tLoad(tLoad),
+    _tUnload(tUnload), _first(first), _slots(slots), _startTimes(startTimes), _setupTimes(setupTimes),
+    _loadTimes(loadTimes), _travelTo(travelTo)
+  {
+    home.notice(*this, AP_DISPOSE);
+  }
+
+  static void post(Home home, ViewArray<Int::IntView> &deliveries, ViewArray<Int::IntView> &order,
+                   ViewArray<Int::IntView> &station, ViewArray<Int::IntView> &tLoad,
+                   ViewArray<Int::IntView> &tUnload, const SharedArray<int> &first, const SharedArray<int> &slots,
+                   const SharedArray<int> &startTimes, const SharedArray<int> &setupTimes,
+                   const SharedArray<int> &loadTimes, const SharedArray<int> &travelTo)
+  {
+    (void) new (home) SerialSchedule(home, deliveries, order, station, tLoad, tUnload, first, slots,
+                                     startTimes, setupTimes, loadTimes, travelTo);
+  }
+
+  virtual Actor* copy(Space &home, bool share)
+  {
+    return new (home) SerialSchedule(home, share, *this);
+  }
+
+  virtual size_t dispose(Space &home)
+  {
+    home.ignore(*this, AP_DISPOSE);
+    _first.~SharedArray<int>();
+    _slots.~SharedArray<int>();
+    _startTimes.~SharedArray<int>();
+    _setupTimes.~SharedArray<int>();
+    _loadTimes.~SharedArray<int>();
+    _travelTo.~SharedArray<int>();
+    (void) Brancher::dispose(home);
+    return sizeof(*this);
+  }
+
+  virtual bool status(const Space&) const
+  {
+    for (int i = 0; i < _deliveries.size(); i++) {
+      if (!_deliveries[i].assigned() || openSlot(i) >= 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  virtual Choice* choice(Space&)
+  {
+    // the vehicle that can load earliest, slots with only times left come first
+    int vehicle = -1;
+    int slot = -1;
+    int time = INT_MAX;
+    bool times = false;
+    int endVehicle = -1;
+
+    for (int i = 0; i < _deliveries.size(); i++) {
+      int d = openSlot(i);
+      if (d < 0) {
+        if (endVehicle < 0 && !_deliveries[i].assigned()) endVehicle = i;
+        continue;
+      }
+
+      int t = _tLoad[_first[i] + d].min();
+      bool onlyT = onlyTimes(i, d);
+      if (vehicle < 0 || (onlyT && !times) || (onlyT == times && t < time)) {
+        vehicle = i;
+        slot = d;
+        time = t;
+        times = onlyT;
+      }
+    }
+
+    // all used slots are decided, only the length of a tour is left
+    if (vehicle < 0) {
+      return new SlotChoice(*this, 2, TOUR_END, endVehicle, 0, _deliveries[endVehicle].min());
+    }
+
+    int k = _first[vehicle] + slot;
+    if (times) {
+      if (!_tUnload[k].assigned()) {
+        return new SlotChoice(*this, 2, SLOT_UNLOAD, vehicle, slot, _tUnload[k].min());
+      }
+      return new SlotChoice(*this, 2, SLOT_LOAD, vehicle, slot, _tLoad[k].max());
+    }
+
+    int numS = _loadTimes.size();
+    std::vector<Candidate> candidates;
+    for (Int::ViewValues<Int::IntView> o(_order[k]); o(); ++o) {
+      for (Int::ViewValues<Int::IntView> s(_station[k]); s(); ++s) {
+        Candidate c;
+        c.order = o.val();
+        c.station = s.val();
+        c.unload = std::max((long long) _startTimes[c.order],
+                            (long long) _tLoad[k].min() + _loadTimes[c.station] +
+                            _travelTo[c.order * numS + c.station] + _setupTimes[c.order]);
+        if (c.unload <= _tUnload[k].max()) {
+          candidates.push_back(c);
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    // ending the tour is tried last, and only if the slot may stay unused
+    bool canEnd = slot >= _deliveries[vehicle].min() || candidates.empty();
+
+    SlotChoice *c = new SlotChoice(*this, candidates.size() + (canEnd ? 1 : 0), SLOT_ASSIGN, vehicle, slot, 0);
+    for (size_t i = 0; i < candidates.size(); i++) {
+      c->orders.push_back(candidates[i].order);
+      c->stations.push_back(candidates[i].station);
+    }
+    return c;
+  }
+
+  virtual Choice* choice(const Space&, Archive &e)
+  {
+    unsigned int alternatives;
+    int kind, vehicle, slot, value, n;
+    e >> alternatives >> kind >> vehicle >> slot >> value >> n;
+
+    SlotChoice *c = new SlotChoice(*this, alternatives, kind, vehicle, slot, value);
+    for (int i = 0; i < n; i++) {
+      int o, s;
+      e >> o >> s;
+      c->orders.push_back(o);
+      c->stations.push_back(s);
+    }
+    return c;
+  }
+
+  virtual ExecStatus commit(Space &home, const Choice &choice, unsigned int a)
+  {
+    const SlotChoice &c = static_cast<const SlotChoice&>(choice);
+    int k = _first[c.vehicle] + c.slot;
+
+    switch (c.kind) {
+    case SLOT_ASSIGN:
+      if (a < c.orders.size()) {
+        GECODE_ME_CHECK(_deliveries[c.vehicle].gr(home, c.slot));
+        GECODE_ME_CHECK(_order[k].eq(home, c.orders[a]));
+        GECODE_ME_CHECK(_station[k].eq(home, c.stations[a]));
+      } else {
+        GECODE_ME_CHECK(_deliveries[c.vehicle].lq(home, c.slot));
+      }
+      break;
+    case SLOT_UNLOAD:
+      GECODE_ME_CHECK(a == 0 ? _tUnload[k].eq(home, c.value) : _tUnload[k].gr(home, c.value));
+      break;
+    case SLOT_LOAD:
+      GECODE_ME_CHECK(a == 0 ? _tLoad[k].eq(home, c.value) : _tLoad[k].le(home, c.value));
+      break;
+    case TOUR_END:
+      GECODE_ME_CHECK(a == 0 ? _deliveries[c.vehicle].eq(home, c.value) : _deliveries[c.vehicle].gr(home, c.value));
+      break;
+    }
+    return ES_OK;
+  }
+
+  virtual void print(const Space&, const Choice &choice, unsigned int a, std::ostream &out) const
+  {
+    const SlotChoice &c = static_cast<const SlotChoice&>(choice);
+    out << "vehicle " << c.vehicle << " slot " << c.slot << ": ";
+
+    switch (c.kind) {
+    case SLOT_ASSIGN:
+      if (a < c.orders.size()) {
+        out << "order " << c.orders[a] << ", station " << c.stations[a];
+      } else {
+        out << "end of tour";
+      }
+      break;
+    case SLOT_UNLOAD:
+      out << "unload " << (a == 0 ? "= " : "> ") << c.value;
+      break;
+    case SLOT_LOAD:
+      out << "load " << (a == 0 ? "= " : "< ") << c.value;
+      break;
+    case TOUR_END:
+      out << "deliveries " << (a == 0 ? "= " : "> ") << c.value;
+      break;
+    }
+  }
+};
+
+void serialSchedule(Home home, const IntVarArgs &deliveries, const IntVarArgs &order, const IntVarArgs &station,
+                    const IntVarArgs &tLoad, const IntVarArgs &tUnload,
+                    const IntArgs &first, const IntArgs &slots,
+                    const IntArgs &startTimes, const IntArgs &setupTimes,
+                    const IntArgs &loadTimes, const IntArgs &travelTo)
+{
+  if (home.failed()) return;
+
+  ViewArray<Int::IntView> n(home, deliveries);
+  ViewArray<Int::IntView> o(home, order);
+  ViewArray<Int::IntView> s(home, station);
+  ViewArray<Int::IntView> l(home, tLoad);
+  ViewArray<Int::IntView> u(home, tUnload);
+
+  SerialSchedule::post(home, n, o, s, l, u, SharedArray<int>(first), SharedArray<int>(slots),
+                       SharedArray<int>(startTimes), SharedArray<int>(setupTimes),
+                       SharedArray<int>(loadTimes), SharedArray<int>(travelTo));
+}
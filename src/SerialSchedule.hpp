@@ -0,0 +1,35 @@
+/*
+ * SerialSchedule.hpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#ifndef SERIALSCHEDULE_HPP_
+#define SERIALSCHEDULE_HPP_
+
+#include <gecode/int.hh>
+
+using namespace Gecode;
+
+/**
+ * Brancher building the tours of all vehicles in time order (serial schedule generation).
+ * Vehicle i has the slots first[i] .. first[i] + slots[i] - 1 of the per delivery arrays, and
+ * deliveries[i] of them are used.
+ *
+ * At every node the brancher takes the first open slot of the vehicle that can load earliest.
+ * It chooses order and station of the slot together, trying all pairs left in the domains by
+ * their earliest start of unloading, and as last alternative ends the tour of the vehicle. The
+ * times of a slot with order and station are decided right away: unloading as early as possible,
+ * then loading as late as possible.
+ *
+ * startTimes, setupTimes are per order, loadTimes per station and travelTo is indexed by
+ * order * numS + station; they only rank the alternatives.
+ */
+void serialSchedule(Home home, const IntVarArgs &deliveries, const IntVarArgs &order, const IntVarArgs &station,
+                    const IntVarArgs &tLoad, const IntVarArgs &tUnload,
+                    const IntArgs &first, const IntArgs &slots,
+                    const IntArgs &startTimes, const IntArgs &setupTimes,
+                    const IntArgs &loadTimes, const IntArgs &travelTo);
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ * SumByKey.cpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#include "SumByKey.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+/// Apply a modification event, fail the propagator or note the change
+#define SUM_MODIFY(me) do {                    \
+    ModEvent me_ = (me);                       \
+    GECODE_ME_CHECK(me_);                      \
+    changed = changed || me_modified(me_);     \
+  } while (0)
+
+class SumByKey : public Propagator {
+protected:
+  ViewArray<Int::IntView> _keys;
+  ViewArray<Int::IntView> _values;
+  ViewArray<Int::IntView> _sums;
+
+  SumByKey(Space &home, bool share, SumByKey &p)
+  : Propagator(home, share, p)
+  {
+    _keys.update(home, share, p._keys);
+    _values.update(home, share, p._values);
+    _sums.update(home, share, p._sums);
+  }
+
+public:
+  SumByKey(Home home, ViewArray<Int::IntView> &keys, ViewArray<Int::IntView> &values,
+           ViewArray<Int::IntView> &sums)
+  : Propagator(home), _keys(keys), _values(values), _sums(sums)
+  {
+    _keys.subscribe(home, *this, Int::PC_INT_DOM);
+    _values.subscribe(home, *this, Int::PC_INT_BND);
+    _sums.subscribe(home, *this, Int::PC_INT_BND);
+  }
+
+  static ExecStatus post(Home home, ViewArray<Int::IntView> &keys, ViewArray<Int::IntView> &values,
+                         ViewArray<Int::IntView> &sums)
+  {
+    for (int d = 0; d < keys.size(); d++) {
+      GECODE_ME_CHECK(keys[d].gq(home, 0));
+      GECODE_ME_CHECK(keys[d].le(home, sums.size()));
+    }
+    (void) new (home) SumByKey(home, keys, values, sums);
+    return ES_OK;
+  }
+
+  virtual Actor* copy(Space &home, bool share)
+  {
+    return new (home) SumByKey(home, share, *this);
+  }
+
+  virtual PropCost cost(const Space&, const ModEventDelta&) const
+  {
+    return PropCost::linear(PropCost::HI, _keys.size() + _sums.size());
+  }
+
+  virtual size_t dispose(Space &home)
+  {
+    _keys.cancel(home, *this, Int::PC_INT_DOM);
+    _values.cancel(home, *this, Int::PC_INT_BND);
+    _sums.cancel(home, *this, Int::PC_INT_BND);
+    (void) Propagator::dispose(home);
+    return sizeof(*this);
+  }
+
+  virtual ExecStatus propagate(Space &home, const ModEventDelta&)
+  {
+    int n = _keys.size();
+    int m = _sums.size();
+
+    // Bounds of the sums over the values that are fixed to a key (lo), and over all values that
+    // may still take a key (hi). Modifications within one pass only tighten the views, so using
+    // the bounds of the start of the pass is weaker but sound.
+    std::vector<long long> lo(m);
+    std::vector<long long> hi(m);
+    std::vector<int> removed;
+
+    bool changed;
+    do {
+      changed = false;
+
+      std::fill(lo.begin(), lo.end(), 0);
+      std::fill(hi.begin(), hi.end(), 0);
+      for (int d = 0; d < n; d++) {
+        if (_keys[d].assigned()) {
+          lo[_keys[d].val()] += _values[d].min();
+          hi[_keys[d].val()] += _values[d].max();
+        } else {
+          for (Int::ViewValues<Int::IntView> i(_keys[d]); i(); ++i) {
+            hi[i.val()] += _values[d].max();
+          }
+        }
+      }
+
+      for (int i = 0; i < m; i++) {
+        SUM_MODIFY(_sums[i].gq(home, lo[i]));
+        SUM_MODIFY(_sums[i].lq(home, hi[i]));
+      }
+
+      for (int d = 0; d < n; d++) {
+        if (_keys[d].assigned()) {
+          int k = _keys[d].val();
+          SUM_MODIFY(_values[d].gq(home, _sums[k].min() - (hi[k] - _values[d].max())));
+          SUM_MODIFY(_values[d].lq(home, _sums[k].max() - (lo[k] - _values[d].min())));
+          continue;
+        }
+
+        // Keys for which the value would exceed the sum, or without which the sum can not be
+        // reached any more
+        removed.clear();
+        int forced = -1;
+        long long maxValue = LLONG_MIN;
+        for (Int::ViewValues<Int::IntView> i(_keys[d]); i(); ++i) {
+          if (lo[i.val()] + _values[d].min() > _sums[i.val()].max()) {
+            removed.push_back(i.val());
+            continue;
+          }
+          if (hi[i.val()] - _values[d].max() < _sums[i.val()].min()) {
+            forced = i.val();
+          }
+          maxValue = std::max(maxValue, _sums[i.val()].max() - lo[i.val()]);
+        }
+
+        if (forced >= 0) {
+          SUM_MODIFY(_keys[d].eq(home, forced));
+          continue;
+        }
+        for (size_t j = 0; j < removed.size(); j++) {
+          SUM_MODIFY(_keys[d].nq(home, removed[j]));
+        }
+        if (maxValue != LLONG_MIN) {
+          SUM_MODIFY(_values[d].lq(home, maxValue));
+        }
+      }
+    } while (changed);
+
+    if (_keys.assigned() && _values.assigned() && _sums.assigned()) {
+      return home.ES_SUBSUMED(*this);
+    }
+    return ES_FIX;
+  }
+};
+
+void sumByKey(Home home, const IntVarArgs &keys, const IntVarArgs &values, const IntVarArgs &sums)
+{
+  for (int i = 0; i < values.size(); i++) {
+    if (values[i].min() < 0) {
+      throw Int::OutOfLimits("sumByKey");
+    }
+  }
+
+  if (home.failed()) return;
+
+  ViewArray<Int::IntView> k(home, keys);
+  ViewArray<Int::IntView> v(home, values);
+  ViewArray<Int::IntView> s(home, sums);
+
+  GECODE_ES_FAIL(SumByKey::post(home, k, v, s));
+}
@@ -0,0 +1,25 @@
+/*
+ * SumByKey.hpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#ifndef SUMBYKEY_HPP_
+#define SUMBYKEY_HPP_
+
+#include <gecode/int.hh>
+
+using namespace Gecode;
+
+/**
+ * Sum of values grouped by key:
+ *
+ *   sums[i] = sum of values[d] over all d with keys[d] == i
+ *
+ * Keys are restricted to 0 .. sums.size() - 1. Values must be non-negative, the bounds of the sums
+ * and the pruning of keys rely on it. Throws Int::OutOfLimits if a value can be negative.
+ */
+void sumByKey(Home home, const IntVarArgs &keys, const IntVarArgs &values, const IntVarArgs &sums);
+
+#endif
@@ -0,0 +1,282 @@
+/*
+ * VehicleChain.cpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#include "VehicleChain.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+/// Apply a modification event, fail the propagator or note the change
+#define CHAIN_MODIFY(me) do {                  \
+    ModEvent me_ = (me);                       \
+    GECODE_ME_CHECK(me_);                      \
+    changed = changed || me_modified(me_);     \
+  } while (0)
+
+class VehicleChain : public Propagator {
+protected:
+  ViewArray<Int::IntView> _order;
+  ViewArray<Int::IntView> _station;
+  ViewArray<Int::IntView> _tLoad;
+  ViewArray<Int::IntView> _tUnload;
+  ViewArray<Int::IntView> _unloading;
+  ViewArray<Int::IntView> _travelTo;
+  ViewArray<Int::IntView> _travelFrom;
+  ViewArray<Int::BoolView> _used;
+
+  SharedArray<int> _loadTimes;
+  SharedArray<int> _setupTimes;
+  SharedArray<int> _travelToTable;
+  SharedArray<int> _travelFromTable;
+  int _available;
+
+  VehicleChain(Space &home, bool share, VehicleChain &p)
+  : Propagator(home, share, p), _available(p._available)
+  {
+    _order.update(home, share, p._order);
+    _station.update(home, share, p._station);
+    _tLoad.update(home, share, p._tLoad);
+    _tUnload.update(home, share, p._tUnload);
+    _unloading.update(home, share, p._unloading);
+    _travelTo.update(home, share, p._travelTo);
+    _travelFrom.update(home, share, p._travelFrom);
+    _used.update(home, share, p._used);
+    _loadTimes.update(home, share, p._loadTimes);
+    _setupTimes.update(home, share, p._setupTimes);
+    _travelToTable.update(home, share, p._travelToTable);
+    _travelFromTable.update(home, share, p._travelFromTable);
+  }
+
+  /**
+   * Restrict a travel time to the table entries of all pairs of an order and a station value
+   * within the bounds of the travel time. If the slot is used, order and station values without
+   * such a pair are removed; if there is no pair at all, the slot can not be used.
+   * minChain is the smallest entry, plus load and setup times if withLead is set, or
+   * LLONG_MAX if there is no pair.
+   */
+  ExecStatus travel(Space &home, Int::IntView order, Int::IntView station, Int::IntView time,
+                    const SharedArray<int> &table, bool withLead, Int::BoolView used,
+                    long long &minChain, bool &changed)
+  {
+    int numS = _loadTimes.size();
+
+    long long minTime = LLONG_MAX;
+    long long maxTime = LLONG_MIN;
+    minChain = LLONG_MAX;
+
+    std::vector<int> supportedOrders;
+    std::vector<bool> supportedStations(numS, false);
+
+    for (Int::ViewValues<Int::IntView> o(order); o(); ++o) {
+      bool supported = false;
+      for (Int::ViewValues<Int::IntView> s(station); s(); ++s) {
+        int t = table[o.val() * numS + s.val()];
+        if (t < time.min() || t > time.max()) continue;
+
+        supported = true;
+        supportedStations[s.val()] = true;
+        minTime = std::min(minTime, (long long) t);
+        maxTime = std::max(maxTime, (long long) t);
+
+        long long chain = t;
+        if (withLead) {
+          chain += _loadTimes[s.val()] + _setupTimes[o.val()];
+        }
+        minChain = std::min(minChain, chain);
+      }
+      if (supported) {
+        supportedOrders.push_back(o.val());
+      }
+    }
+
+    if (supportedOrders.empty()) {
+      if (used.one()) return ES_FAILED;
+      CHAIN_MODIFY(used.zero(home));
+      return ES_OK;
+    }
+    if (!used.one()) {
+      return ES_OK;
+    }
+
+    CHAIN_MODIFY(time.gq(home, minTime));
+    CHAIN_MODIFY(time.lq(home, maxTime));
+
+    // remove values without support, collected first to not modify the domains while iterating
+    std::vector<int> unsupported;
+    for (Int::ViewValues<Int::IntView> o(order); o(); ++o) {
+      if (!std::binary_search(supportedOrders.begin(), supportedOrders.end(), o.val())) {
+        unsupported.push_back(o.val());
+      }
+    }
+    for (size_t i = 0; i < unsupported.size(); i++) {
+      CHAIN_MODIFY(order.nq(home, unsupported[i]));
+    }
+    unsupported.clear();
+    for (Int::ViewValues<Int::IntView> s(station); s(); ++s) {
+      if (!supportedStations[s.val()]) {
+        unsupported.push_back(s.val());
+      }
+    }
+    for (size_t i = 0; i < unsupported.size(); i++) {
+      CHAIN_MODIFY(station.nq(home, unsupported[i]));
+    }
+
+    return ES_OK;
+  }
+
+  bool allAssigned() const
+  {
+    return _order.assigned() && _station.assigned() && _tLoad.assigned() && _tUnload.assigned() &&
+           _unloading.assigned() && _travelTo.assigned() && _travelFrom.assigned() && _used.assigned();
+  }
+
+public:
+  VehicleChain(Home home, ViewArray<Int::IntView> &order, ViewArray<Int::IntView> &station,
+               ViewArray<Int::IntView> &tLoad, ViewArray<Int::IntView> &tUnload,
+               ViewArray<Int::IntView> &unloading, ViewArray<Int::IntView> &travelTo,
+               ViewArray<Int::IntView> &travelFrom, ViewArray<Int::BoolView> &used,
+               const SharedArray<int> &loadTimes, const SharedArray<int> &setupTimes,
+               const SharedArray<int> &travelToTable, const SharedArray<int> &travelFromTable,
+               int available)
+  : Propagator(home), _order(order), _station(station), _tLoad(tLoad), _tUnload(tUnload),
+    _unloading(unloading), _travelTo(travelTo), _travelFrom(travelFrom), _used(used),
+    _loadTimes(loadTimes), _setupTimes(setupTimes), _travelToTable(travelToTable),
+    _travelFromTable(travelFromTable), _available(available)
+  {
+    _order.subscribe(home, *this, Int::PC_INT_DOM);
+    _station.subscribe(home, *this, Int::PC_INT_DOM);
+    _tLoad.subscribe(home, *this, Int::PC_INT_BND);
+    _tUnload.subscribe(home, *this, Int::PC_INT_BND);
+    _unloading.subscribe(home, *this, Int::PC_INT_BND);
+    _travelTo.subscribe(home, *this, Int::PC_INT_BND);
+    _travelFrom.subscribe(home, *this, Int::PC_INT_BND);
+    _used.subscribe(home, *this, Int::PC_BOOL_VAL);
+  }
+
+  static ExecStatus post(Home home, ViewArray<Int::IntView> &order, ViewArray<Int::IntView> &station,
+                         ViewArray<Int::IntView> &tLoad, ViewArray<Int::IntView> &tUnload,
+                         ViewArray<Int::IntView> &unloading, ViewArray<Int::IntView> &travelTo,
+                         ViewArray<Int::IntView> &travelFrom, ViewArray<Int::BoolView> &used,
+                         const SharedArray<int> &loadTimes, const SharedArray<int> &setupTimes,
+                         const SharedArray<int> &travelToTable, const SharedArray<int> &travelFromTable,
+                         int available)
+  {
+    if (order.size() == 0) {
+      return ES_OK;
+    }
+    (void) new (home) VehicleChain(home, order, station, tLoad, tUnload, unloading, travelTo, travelFrom,
+                                   used, loadTimes, setupTimes, travelToTable, travelFromTable, available);
+    return ES_OK;
+  }
+
+  virtual Actor* copy(Space &home, bool share)
+  {
+    return new (home) VehicleChain(home, share, *this);
+  }
+
+  virtual PropCost cost(const Space&, const ModEventDelta&) const
+  {
+    return PropCost::linear(PropCost::HI, _order.size());
+  }
+
+  virtual size_t dispose(Space &home)
+  {
+    _order.cancel(home, *this, Int::PC_INT_DOM);
+    _station.cancel(home, *this, Int::PC_INT_DOM);
+    _tLoad.cancel(home, *this, Int::PC_INT_BND);
+    _tUnload.cancel(home, *this, Int::PC_INT_BND);
+    _unloading.cancel(home, *this, Int::PC_INT_BND);
+    _travelTo.cancel(home, *this, Int::PC_INT_BND);
+    _travelFrom.cancel(home, *this, Int::PC_INT_BND);
+    _used.cancel(home, *this, Int::PC_BOOL_VAL);
+    _loadTimes.~SharedArray<int>();
+    _setupTimes.~SharedArray<int>();
+    _travelToTable.~SharedArray<int>();
+    _travelFromTable.~SharedArray<int>();
+    (void) Propagator::dispose(home);
+    return sizeof(*this);
+  }
+
+  virtual ExecStatus propagate(Space &home, const ModEventDelta&)
+  {
+    int n = _order.size();
+    bool changed;
+
+    do {
+      changed = false;
+
+      for (int d = 0; d < n; d++) {
+        // Travel to the yard, and the time from the start of loading to the start of unloading
+        if (_used[d].zero()) {
+          CHAIN_MODIFY(_travelTo[d].eq(home, 0));
+        } else {
+          long long minLead;
+          GECODE_ES_CHECK(travel(home, _order[d], _station[d], _travelTo[d], _travelToTable, true,
+                                 _used[d], minLead, changed));
+
+          if (_used[d].one()) {
+            CHAIN_MODIFY(_tUnload[d].gq(home, _tLoad[d].min() + minLead));
+            CHAIN_MODIFY(_tLoad[d].lq(home, _tUnload[d].max() - minLead));
+            if (d == 0) {
+              CHAIN_MODIFY(_tLoad[d].gq(home, _available));
+            }
+          } else if (_used[d].none() &&
+                     (_tLoad[d].min() + minLead > _tUnload[d].max() || (d == 0 && _tLoad[d].max() < _available))) {
+            CHAIN_MODIFY(_used[d].zero(home));
+          }
+        }
+
+        // Travel back to the station of the next delivery, which can only be loaded afterwards
+        if (d == n - 1 || _used[d+1].zero()) {
+          CHAIN_MODIFY(_travelFrom[d].eq(home, 0));
+        } else {
+          long long minFrom;
+          GECODE_ES_CHECK(travel(home, _order[d], _station[d+1], _travelFrom[d], _travelFromTable, false,
+                                 _used[d+1], minFrom, changed));
+
+          if (_used[d+1].one()) {
+            long long gap = minFrom + _unloading[d].min();
+            CHAIN_MODIFY(_tLoad[d+1].gq(home, _tUnload[d].min() + gap));
+            CHAIN_MODIFY(_tUnload[d].lq(home, _tLoad[d+1].max() - gap));
+            CHAIN_MODIFY(_unloading[d].lq(home, _tLoad[d+1].max() - _tUnload[d].min() - minFrom));
+          } else if (_used[d+1].none() && _tUnload[d].min() + _unloading[d].min() + minFrom > _tLoad[d+1].max()) {
+            CHAIN_MODIFY(_used[d+1].zero(home));
+          }
+        }
+      }
+    } while (changed);
+
+    if (allAssigned()) {
+      return home.ES_SUBSUMED(*this);
+    }
+    return ES_FIX;
+  }
+};
+
+void vehicleChain(Home home, const IntVarArgs &order, const IntVarArgs &station,
+                  const IntVarArgs &tLoad, const IntVarArgs &tUnload, const IntVarArgs &unloading,
+                  const IntVarArgs &travelTo, const IntVarArgs &travelFrom, const BoolVarArgs &used,
+                  const IntArgs &loadTimes, const IntArgs &setupTimes,
+                  const IntArgs &travelToTable, const IntArgs &travelFromTable, int available)
+{
+  if (home.failed()) return;
+
+  ViewArray<Int::IntView> o(home, order);
+  ViewArray<Int::IntView> s(home, station);
+  ViewArray<Int::IntView> l(home, tLoad);
+  ViewArray<Int::IntView> u(home, tUnload);
+  ViewArray<Int::IntView> dt(home, unloading);
+  ViewArray<Int::IntView> to(home, travelTo);
+  ViewArray<Int::IntView> from(home, travelFrom);
+  ViewArray<Int::BoolView> b(home, used);
+
+  GECODE_ES_FAIL(VehicleChain::post(home, o, s, l, u, dt, to, from, b,
+                                    SharedArray<int>(loadTimes), SharedArray<int>(setupTimes),
+                                    SharedArray<int>(travelToTable), SharedArray<int>(travelFromTable),
+                                    available));
+}
@@ -0,0 +1,33 @@
+/*
+ * VehicleChain.hpp
+ *
+ *  Created on: Mar 21, 2014
+ *  Author: stefan
+ */
+
+#ifndef VEHICLECHAIN_HPP_
+#define VEHICLECHAIN_HPP_
+
+#include <gecode/int.hh>
+
+using namespace Gecode;
+
+/**
+ * Timing of the tour of one vehicle. For every used slot d of the tour:
+ *
+ *   travelTo[d]   = travelToTable[order[d] * numS + station[d]]
+ *   travelFrom[d] = travelFromTable[order[d] * numS + station[d+1]]   (0 for the last used slot)
+ *   tLoad[d] + loadTimes[station[d]] + travelTo[d] + setupTimes[order[d]] <= tUnload[d]
+ *   tUnload[d] + unloading[d] + travelFrom[d] <= tLoad[d+1]
+ *   tLoad[0] >= available
+ *
+ * Travel times of unused slots are 0. The tables are indexed by order and station, numS is the
+ * size of loadTimes. Used slots must form a prefix of the tour.
+ */
+void vehicleChain(Home home, const IntVarArgs &order, const IntVarArgs &station,
+                  const IntVarArgs &tLoad, const IntVarArgs &tUnload, const IntVarArgs &unloading,
+                  const IntVarArgs &travelTo, const IntVarArgs &travelFrom, const BoolVarArgs &used,
+                  const IntArgs &loadTimes, const IntArgs &setupTimes,
+                  const IntArgs &travelToTable, const IntArgs &travelFromTable, int available);
+
+#endif
@@ -16,7 +16,8 @@
 #include <string>
 
 struct _StationDuration_{
-  std::string _stationCode;
+  /// index into the station code table of the reader
+  int _station;
   int _drivingMinutes;
   /**
    * as a convention if the direction for the constructionYard is From then _direction is true
@@ -42,14 +43,12 @@ struct _Order_{
   std::string _startTime;
   time_t _unixTimeStamp;
   bool _isPickup;
-  _ConstructionYard_ *_constructionYard;
+  /// index into the construction yard list of the reader, -1 if there is none. Orders share the
+  /// index only if their yards have the same code and the same data.
+  int _constructionYard;
 
   _Order_() : _priority(0), _volume(0), _maxVolumeAllowed(false)
-    , _dischargeRate(0), _pumpLength(0), _unixTimeStamp(0), _isPickup(false), _constructionYard(0){
-  }
-  
-  ~_Order_() {
-    if (_constructionYard) delete _constructionYard;
+    , _dischargeRate(0), _pumpLength(0), _unixTimeStamp(0), _isPickup(false), _constructionYard(-1){
   }
 };
 
@@ -82,7 +81,8 @@ typedef struct _Station_ XMLStation;
 
 /*
  * struct that keeps the information regarding each construction site. It contains a list of
- * StationDurations as member.
+ * StationDurations as member. Orders share a construction yard only if the code and all of its
+ * data are the same, yards with the same code but different data are kept apart.
  */
 typedef struct _ConstructionYard_ XMLConstructionYard;
 /*
@@ -90,7 +90,7 @@ typedef struct _ConstructionYard_ XMLConstructionYard;
  */
 typedef struct _Vehicle_ XMLVehicle;
 /*
- * Struct that keeps the information regarding each order. Each of them has a member of type
+ * Struct that keeps the information regarding each order. Each of them refers to a
  * ConstructionYard, in this way we keep track of what to be delivered and where
  */
 typedef struct _Order_ XMLOrder;